@@ -25,11 +25,21 @@
  * POSSIBILITY OF SUCH DAMAGE.
  */
 
+/* O_DIRECT */
+#define _GNU_SOURCE
+
 #include "adi_memdump.h"
+#include "memdump_container.h"
+#include "memdump_delta.h"
 
 #include <errno.h>
 #include <fcntl.h>
+#include <limits.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #define TA_ADI_MEMDUMP_UUID \
 	{ \
@@ -47,7 +57,9 @@
 enum ta_adimem_cmds {
 	TA_ADI_MEMDUMP_RECORDS_CMD,
 	TA_ADI_MEMDUMP_SIZE_CMD,
-	TA_ADI_MEMDUMP_CMD
+	TA_ADI_MEMDUMP_CMD,
+	TA_ADI_MEMDUMP_CHUNK_CMD,
+	TA_ADI_MEMDUMP_DESCRIPTORS_CMD
 };
 
 /* Op parameter offsets */
@@ -64,123 +76,235 @@ enum ta_adimem_cmds {
 #define OP_PARAM_WIDTH 2
 #define OP_PARAM_ENDIANNESS 3
 
+/* adi_memdump_fetch_chunk */
+#define OP_PARAM_CHUNK_BUFFER 0
+#define OP_PARAM_CHUNK_RECORD_AND_ADDRESS 1
+#define OP_PARAM_CHUNK_OFFSET 2
+#define OP_PARAM_CHUNK_WIDTH_AND_ENDIANNESS 3
+
+/* adi_memdump_descriptors */
+#define OP_PARAM_DESCRIPTORS_BUFFER 0
+#define OP_PARAM_DESCRIPTORS_RECORDS 1
+
 /**
- * adi_memdump_get_num_records - Open a TEE session to get number of records for memdump
+ * adi_memdump_open_session - Initialize a TEE context and open a session to the memdump TA
  */
-TEEC_Result adi_memdump_get_num_records(void)
+TEEC_Result adi_memdump_open_session(memdump_session_t *session)
 {
 	TEEC_Result res;
-	TEEC_Context ctx;
-	TEEC_Session sess;
-	TEEC_Operation op;
 	TEEC_UUID uuid = TA_ADI_MEMDUMP_UUID;
 	uint32_t err_origin;
 
 	/* Initialize a context connecting us to the TEE */
-	res = TEEC_InitializeContext(NULL, &ctx);
+	res = TEEC_InitializeContext(NULL, &session->ctx);
 	if (res != TEEC_SUCCESS) {
 		printf("TEEC_InitializeContext failed with code 0x%x\n", res);
 		return res;
 	}
 
 	/* Open a session to the TA. */
-	res = TEEC_OpenSession(&ctx, &sess, &uuid, TEEC_LOGIN_PUBLIC, NULL, NULL, &err_origin);
+	res = TEEC_OpenSession(&session->ctx, &session->sess, &uuid, TEEC_LOGIN_PUBLIC, NULL, NULL, &err_origin);
 	if (res != TEEC_SUCCESS) {
 		printf("TEEC_Opensession failed with code 0x%x origin 0x%x\n", res, err_origin);
-		TEEC_FinalizeContext(&ctx);
+		TEEC_FinalizeContext(&session->ctx);
 		return res;
 	}
 
+	return TEEC_SUCCESS;
+}
+
+/**
+ * adi_memdump_close_session - Close the session and destroy the context
+ */
+void adi_memdump_close_session(memdump_session_t *session)
+{
+	TEEC_CloseSession(&session->sess);
+	TEEC_FinalizeContext(&session->ctx);
+}
+
+/**
+ * adi_memdump_num_records - Get number of records for memdump
+ */
+TEEC_Result adi_memdump_num_records(memdump_session_t *session, uint32_t *num_records)
+{
+	TEEC_Result res;
+	TEEC_Operation op;
+	uint32_t err_origin;
+
 	/* Prepare the TEEC_Operation struct */
 	memset(&op, 0, sizeof(op));
 	op.paramTypes = TEEC_PARAM_TYPES(TEEC_VALUE_OUTPUT, TEEC_NONE, TEEC_NONE, TEEC_NONE);
 
 	/* Invoke the function */
-	res = TEEC_InvokeCommand(&sess, TA_ADI_MEMDUMP_RECORDS_CMD, &op, &err_origin);
+	res = TEEC_InvokeCommand(&session->sess, TA_ADI_MEMDUMP_RECORDS_CMD, &op, &err_origin);
 	if (res != TEEC_SUCCESS)
 		printf("tee_memdump failed with code 0x%x origin 0x%x\n", res, err_origin);
 	else
-		/* Print number of records */
-		printf("0x%08x\n", op.params[OP_PARAM_RECORDS].value.a);
-
-	/* Close the session and destroy the context */
-	TEEC_CloseSession(&sess);
-	TEEC_FinalizeContext(&ctx);
+		*num_records = op.params[OP_PARAM_RECORDS].value.a;
 
 	return res;
 }
 
 /**
- * adi_memdump - Open a TEE session to dump memory region of specified record
+ * adi_memdump_unknown_cmd - Whether an invoke failed because the TA lacks the command
+ *
+ * The TA dispatcher answers an unknown command ID with BAD_PARAMETERS, other
+ * TAs with NOT_SUPPORTED or NOT_IMPLEMENTED.
  */
-TEEC_Result adi_memdump(uint64_t record)
+bool adi_memdump_unknown_cmd(TEEC_Result res)
+{
+	return res == TEEC_ERROR_NOT_SUPPORTED || res == TEEC_ERROR_BAD_PARAMETERS ||
+	       res == TEEC_ERROR_NOT_IMPLEMENTED;
+}
+
+/**
+ * adi_memdump_record_size - Get size of a memdump record
+ */
+TEEC_Result adi_memdump_record_size(memdump_session_t *session, uint32_t record, uint32_t *size)
 {
 	TEEC_Result res;
-	TEEC_Context ctx;
-	TEEC_Session sess;
 	TEEC_Operation op;
-	TEEC_UUID uuid = TA_ADI_MEMDUMP_UUID;
 	uint32_t err_origin;
-	TEEC_SharedMemory output_buf;
-	FILE *fp;
-	uint32_t size = 0;
-	uint8_t *data = NULL;
 
-	/* Initialize data structure for shared buffer */
-	memset((void *)&output_buf, 0, sizeof(output_buf));
+	/* Prepare the TEEC_Operation struct */
+	memset(&op, 0, sizeof(op));
+	op.paramTypes = TEEC_PARAM_TYPES(TEEC_VALUE_INPUT, TEEC_VALUE_OUTPUT, TEEC_NONE, TEEC_NONE);
+	op.params[OP_PARAM_RECORD_NUM].value.a = record;
 
-	/* Initialize a context connecting us to the TEE */
-	res = TEEC_InitializeContext(NULL, &ctx);
-	if (res != TEEC_SUCCESS) {
-		printf("TEEC_InitializeContext failed with code 0x%x\n", res);
-		return res;
-	}
+	/* Invoke the function to get size of memdump record */
+	res = TEEC_InvokeCommand(&session->sess, TA_ADI_MEMDUMP_SIZE_CMD, &op, &err_origin);
+	if (res != TEEC_SUCCESS)
+		printf("tee_memdump_size failed with code 0x%x origin 0x%x\n", res, err_origin);
+	else
+		*size = op.params[OP_PARAM_RECORD_SIZE].value.a;
 
-	/* Open a session to the TA. */
-	res = TEEC_OpenSession(&ctx, &sess, &uuid, TEEC_LOGIN_PUBLIC, NULL, NULL, &err_origin);
+	return res;
+}
+
+/**
+ * invoke_descriptors - Invoke the descriptor table command into a buffer of *len bytes
+ *
+ * On TEEC_ERROR_SHORT_BUFFER *len is the size the TA needs.
+ */
+static TEEC_Result invoke_descriptors(memdump_session_t *session, memdump_descriptor_t *table, size_t *len,
+				      uint32_t *num_records)
+{
+	TEEC_Result res;
+	TEEC_Operation op;
+	TEEC_SharedMemory table_buf;
+	uint32_t err_origin;
+
+	memset((void *)&table_buf, 0, sizeof(table_buf));
+	table_buf.buffer = table;
+	table_buf.size = *len;
+	table_buf.flags = TEEC_MEM_OUTPUT;
+
+	res = TEEC_RegisterSharedMemory(&session->ctx, &table_buf);
 	if (res != TEEC_SUCCESS) {
-		printf("TEEC_Opensession failed with code 0x%x origin 0x%x\n", res, err_origin);
-		TEEC_FinalizeContext(&ctx);
+		printf("TEEC_RegisterSharedMemory failed with code 0x%x\n", res);
 		return res;
 	}
 
 	/* Prepare the TEEC_Operation struct */
 	memset(&op, 0, sizeof(op));
-	op.paramTypes = TEEC_PARAM_TYPES(TEEC_VALUE_INPUT, TEEC_VALUE_OUTPUT, TEEC_NONE, TEEC_NONE);
-	op.params[OP_PARAM_RECORD_NUM].value.a = record;
+	op.paramTypes = TEEC_PARAM_TYPES(TEEC_MEMREF_WHOLE, TEEC_VALUE_OUTPUT, TEEC_NONE, TEEC_NONE);
+	op.params[OP_PARAM_DESCRIPTORS_BUFFER].memref.parent = &table_buf;
+	op.params[OP_PARAM_DESCRIPTORS_BUFFER].memref.size = *len;
 
-	/* Invoke the function to get size of memdump record */
-	res = TEEC_InvokeCommand(&sess, TA_ADI_MEMDUMP_SIZE_CMD, &op, &err_origin);
-	if (res != TEEC_SUCCESS) {
-		printf("tee_memdump_size failed with code 0x%x origin 0x%x\n", res, err_origin);
-		TEEC_FinalizeContext(&ctx);
-		TEEC_CloseSession(&sess);
-		return res;
+	/* Invoke the function */
+	res = TEEC_InvokeCommand(&session->sess, TA_ADI_MEMDUMP_DESCRIPTORS_CMD, &op, &err_origin);
+	if (res == TEEC_SUCCESS || res == TEEC_ERROR_SHORT_BUFFER) {
+		*len = op.params[OP_PARAM_DESCRIPTORS_BUFFER].memref.size;
+		*num_records = op.params[OP_PARAM_DESCRIPTORS_RECORDS].value.a;
+	} else if (!adi_memdump_unknown_cmd(res)) {
+		/* An older TA without the table is handled by the caller */
+		printf("tee_memdump_descriptors failed with code 0x%x origin 0x%x\n", res, err_origin);
 	}
 
-	/* Get returned size of record */
-	size = op.params[OP_PARAM_RECORD_SIZE].value.a;
+	TEEC_ReleaseSharedMemory(&table_buf);
 
-	/* Buffer to share with OP-TEE TA */
-	data = malloc(size);
+	return res;
+}
 
-	if (data == NULL) {
-		TEEC_FinalizeContext(&ctx);
-		TEEC_CloseSession(&sess);
-		return TEEC_ERROR_GENERIC;
+/**
+ * adi_memdump_descriptors - Get the descriptors of all records in one invoke
+ *
+ * Allocates *infos, freed by the caller, with one entry per record. The table
+ * is asked for with room for MEMDUMP_DESCRIPTORS_HINT records and asked for
+ * again if the TA has more.
+ */
+TEEC_Result adi_memdump_descriptors(memdump_session_t *session, memdump_record_info_t **infos,
+				    uint32_t *num_records)
+{
+	TEEC_Result res = TEEC_ERROR_SHORT_BUFFER;
+	memdump_descriptor_t *table = NULL;
+	size_t len = MEMDUMP_DESCRIPTORS_HINT * sizeof(memdump_descriptor_t);
+	uint32_t num = 0;
+
+	*infos = NULL;
+	for (int tries = 0; tries < 2; tries++) {
+		free(table);
+		table = malloc(len);
+		if (table == NULL)
+			return TEEC_ERROR_OUT_OF_MEMORY;
+
+		res = invoke_descriptors(session, table, &len, &num);
+		if (res != TEEC_ERROR_SHORT_BUFFER)
+			break;
+	}
+	if (res == TEEC_ERROR_SHORT_BUFFER)
+		printf("tee_memdump_descriptors table keeps growing\n");
+	if (res != TEEC_SUCCESS)
+		goto end;
+
+	if (len < (size_t)num * sizeof(memdump_descriptor_t)) {
+		printf("tee_memdump_descriptors returned 0x%zx bytes for 0x%x records\n", len, num);
+		res = TEEC_ERROR_BAD_FORMAT;
+		goto end;
 	}
 
+	*infos = calloc(num ? num : 1, sizeof(memdump_record_info_t));
+	if (*infos == NULL) {
+		res = TEEC_ERROR_OUT_OF_MEMORY;
+		goto end;
+	}
+	for (uint32_t i = 0; i < num; i++) {
+		(*infos)[i].record = table[i].record;
+		(*infos)[i].size = table[i].size;
+		(*infos)[i].address = table[i].address;
+		(*infos)[i].width = table[i].width;
+		(*infos)[i].endianness = table[i].endianness;
+	}
+	*num_records = num;
+
+end:
+	free(table);
+
+	return res;
+}
+
+/**
+ * adi_memdump_fetch - Dump a whole record into buf
+ *
+ * buf must hold the record size returned by adi_memdump_record_size().
+ */
+TEEC_Result adi_memdump_fetch(memdump_session_t *session, uint32_t record, uint8_t *buf, uint32_t size,
+			      memdump_record_info_t *info)
+{
+	TEEC_Result res;
+	TEEC_Operation op;
+	TEEC_SharedMemory output_buf;
+	uint32_t err_origin;
+
 	/* Register shared memory */
-	output_buf.buffer = data;
+	memset((void *)&output_buf, 0, sizeof(output_buf));
+	output_buf.buffer = buf;
 	output_buf.size = size;
 	output_buf.flags = TEEC_MEM_OUTPUT;
 
-	res = TEEC_RegisterSharedMemory(&ctx, &output_buf);
+	res = TEEC_RegisterSharedMemory(&session->ctx, &output_buf);
 	if (res != TEEC_SUCCESS) {
 		printf("TEEC_RegisterSharedMemory failed with code 0x%x\n", res);
-		free(data);
-		TEEC_CloseSession(&sess);
-		TEEC_FinalizeContext(&ctx);
 		return res;
 	}
 
@@ -192,45 +316,666 @@ TEEC_Result adi_memdump(uint64_t record)
 	op.params[OP_PARAM_RECORD_AND_ADDRESS].value.a = record;
 
 	/* Invoke the function */
-	res = TEEC_InvokeCommand(&sess, TA_ADI_MEMDUMP_CMD, &op, &err_origin);
+	res = TEEC_InvokeCommand(&session->sess, TA_ADI_MEMDUMP_CMD, &op, &err_origin);
 	if (res != TEEC_SUCCESS) {
 		printf("tee_memdump failed with code 0x%x origin 0x%x\n", res, err_origin);
 	} else {
-		printf("0x%08x 0x%04x 0x%04x 0x%01x\n", op.params[OP_PARAM_RECORD_AND_ADDRESS].value.a, op.params[OP_PARAM_BUFFER].memref.size, op.params[2].value.a, op.params[3].value.a);
+		info->record = record;
+		info->size = op.params[OP_PARAM_BUFFER].memref.size;
+		info->address = ((uint64_t)op.params[OP_PARAM_RECORD_AND_ADDRESS].value.b << 32) |
+				op.params[OP_PARAM_RECORD_AND_ADDRESS].value.a;
+		info->width = op.params[OP_PARAM_WIDTH].value.a;
+		info->endianness = op.params[OP_PARAM_ENDIANNESS].value.a;
+	}
 
-		/* Dump memory contents to temp binary file */
-		fp = fopen("/tmp/memdump.bin", "wb");
-		if (fp == NULL) {
-			printf("Unable to open file for memdump\n");
-			res = TEEC_ERROR_GENERIC;
-			goto end;
+	TEEC_ReleaseSharedMemory(&output_buf);
+
+	return res;
+}
+
+/**
+ * adi_memdump_fetch_chunk - Dump a window of a record into registered shared memory
+ *
+ * Copies up to *len bytes of the record, starting at byte offset, into shm at
+ * shm_offset. On return *len holds the number of bytes the TA copied, which is
+ * only short at the end of the record. The record address is that of the
+ * first byte of the record, not of the window.
+ */
+TEEC_Result adi_memdump_fetch_chunk(memdump_session_t *session, TEEC_SharedMemory *shm, size_t shm_offset,
+				    uint32_t record, uint64_t offset, uint32_t *len, memdump_record_info_t *info)
+{
+	TEEC_Result res;
+	TEEC_Operation op;
+	uint32_t err_origin;
+
+	/* Prepare the TEEC_Operation struct */
+	memset(&op, 0, sizeof(op));
+	op.paramTypes = TEEC_PARAM_TYPES(TEEC_MEMREF_PARTIAL_OUTPUT, TEEC_VALUE_INOUT, TEEC_VALUE_INPUT,
+					 TEEC_VALUE_OUTPUT);
+	op.params[OP_PARAM_CHUNK_BUFFER].memref.parent = shm;
+	op.params[OP_PARAM_CHUNK_BUFFER].memref.offset = shm_offset;
+	op.params[OP_PARAM_CHUNK_BUFFER].memref.size = *len;
+	op.params[OP_PARAM_CHUNK_RECORD_AND_ADDRESS].value.a = record;
+	op.params[OP_PARAM_CHUNK_OFFSET].value.a = (uint32_t)offset;
+	op.params[OP_PARAM_CHUNK_OFFSET].value.b = (uint32_t)(offset >> 32);
+
+	/* Invoke the function */
+	res = TEEC_InvokeCommand(&session->sess, TA_ADI_MEMDUMP_CHUNK_CMD, &op, &err_origin);
+	if (res != TEEC_SUCCESS) {
+		/* An older TA without chunk support is handled by the caller */
+		if (!adi_memdump_unknown_cmd(res))
+			printf("tee_memdump_chunk failed with code 0x%x origin 0x%x\n", res, err_origin);
+		return res;
+	}
+
+	*len = op.params[OP_PARAM_CHUNK_BUFFER].memref.size;
+	info->record = record;
+	info->address = ((uint64_t)op.params[OP_PARAM_CHUNK_RECORD_AND_ADDRESS].value.b << 32) |
+			op.params[OP_PARAM_CHUNK_RECORD_AND_ADDRESS].value.a;
+	info->width = op.params[OP_PARAM_CHUNK_WIDTH_AND_ENDIANNESS].value.a;
+	info->endianness = op.params[OP_PARAM_CHUNK_WIDTH_AND_ENDIANNESS].value.b;
+
+	return TEEC_SUCCESS;
+}
+
+/**
+ * adi_memdump_get_num_records - Open a TEE session to get number of records for memdump
+ */
+TEEC_Result adi_memdump_get_num_records(void)
+{
+	TEEC_Result res;
+	memdump_session_t session;
+	uint32_t num_records;
+
+	res = adi_memdump_open_session(&session);
+	if (res != TEEC_SUCCESS)
+		return res;
+
+	res = adi_memdump_num_records(&session, &num_records);
+	if (res == TEEC_SUCCESS)
+		/* Print number of records */
+		printf("0x%08x\n", num_records);
+
+	adi_memdump_close_session(&session);
+
+	return res;
+}
+
+/**
+ * describe_records - Get every record's descriptor, or only its size from an older TA
+ *
+ * *described is false if the TA has no descriptor table; the record sizes are
+ * then asked for one at a time and the other fields are left 0.
+ */
+static TEEC_Result describe_records(memdump_session_t *session, memdump_record_info_t **infos,
+				    uint32_t *num_records, bool *described)
+{
+	TEEC_Result res;
+	uint32_t num = 0;
+
+	res = adi_memdump_descriptors(session, infos, num_records);
+	*described = (res == TEEC_SUCCESS);
+	if (!adi_memdump_unknown_cmd(res))
+		return res;
+
+	res = adi_memdump_num_records(session, &num);
+	if (res != TEEC_SUCCESS)
+		return res;
+
+	*infos = calloc(num ? num : 1, sizeof(memdump_record_info_t));
+	if (*infos == NULL)
+		return TEEC_ERROR_OUT_OF_MEMORY;
+
+	for (uint32_t i = 0; i < num; i++) {
+		(*infos)[i].record = i;
+		res = adi_memdump_record_size(session, i, &(*infos)[i].size);
+		if (res != TEEC_SUCCESS) {
+			free(*infos);
+			*infos = NULL;
+			return res;
 		}
-		res = chmod("/tmp/memdump.bin", 0640);
-		if (res != 0) {
-			printf("Unable to change file permissions for /tmp/memdump.bin\n");
+	}
+	*num_records = num;
+
+	return TEEC_SUCCESS;
+}
+
+/**
+ * adi_memdump_list - Open a TEE session to list every record without dumping it
+ *
+ * Prints one line per record and the space a container of them all takes.
+ */
+TEEC_Result adi_memdump_list(void)
+{
+	TEEC_Result res;
+	memdump_session_t session;
+	memdump_record_info_t *infos = NULL;
+	uint64_t *sizes = NULL;
+	uint64_t total = 0;
+	uint32_t num_records = 0;
+	bool described;
+
+	res = adi_memdump_open_session(&session);
+	if (res != TEEC_SUCCESS)
+		return res;
+
+	res = describe_records(&session, &infos, &num_records, &described);
+	if (res != TEEC_SUCCESS)
+		goto end;
+
+	sizes = calloc(num_records ? num_records : 1, sizeof(uint64_t));
+	if (sizes == NULL) {
+		res = TEEC_ERROR_OUT_OF_MEMORY;
+		goto end;
+	}
+
+	printf("record  address             size        width endian\n");
+	for (uint32_t i = 0; i < num_records; i++) {
+		if (described)
+			printf("%6u  0x%016llx  0x%08x  %5u  %5u\n", infos[i].record,
+			       (unsigned long long)infos[i].address, infos[i].size, infos[i].width,
+			       infos[i].endianness);
+		else
+			printf("%6u  %-18s  0x%08x  %5s  %5s\n", infos[i].record, "-", infos[i].size, "-", "-");
+		sizes[i] = infos[i].size;
+		total += infos[i].size;
+	}
+	printf("0x%x records, 0x%llx bytes, container 0x%llx bytes\n", num_records, (unsigned long long)total,
+	       (unsigned long long)memdump_container_size(num_records, sizes));
+
+end:
+	free(sizes);
+	free(infos);
+	adi_memdump_close_session(&session);
+
+	return res;
+}
+
+/**
+ * file_sink - memdump_sink_t writing a record sequentially to a stdio stream
+ */
+static bool file_sink(void *arg, uint8_t *data, size_t len, uint64_t pos)
+{
+	return fwrite(data, 1, len, (FILE *)arg) == len;
+}
+
+/**
+ * open_output - open the output of a single record dump, "-" for stdout
+ *
+ * Dumping to stdout keeps stdout for the data: its descriptor is duplicated
+ * for the dump, and everything printed from then on goes to stderr.
+ *
+ * A regular file is written as path.tmp, named in tmp, and only replaces
+ * path in finish_output once the dump succeeded, so a failed dump leaves the
+ * previous one intact. Pipes and devices are written directly, tmp is "".
+ */
+static int open_output(const char *path, int flags, char tmp[PATH_MAX])
+{
+	struct stat st;
+	int fd;
+
+	tmp[0] = '\0';
+	if (strcmp(path, "-") == 0) {
+		fflush(stdout);
+		fd = dup(STDOUT_FILENO);
+		if (fd < 0 || dup2(STDERR_FILENO, STDOUT_FILENO) < 0) {
+			printf("Unable to redirect stdout: %s\n", strerror(errno));
+			if (fd >= 0)
+				close(fd);
+			return -1;
+		}
+		return fd;
+	}
+
+	/* Pipes and devices keep their own permissions */
+	if (stat(path, &st) == 0 && !S_ISREG(st.st_mode)) {
+		fd = open(path, flags);
+		if (fd < 0)
+			printf("Unable to open file %s for memdump\n", path);
+		return fd;
+	}
+
+	if (snprintf(tmp, PATH_MAX, "%s.tmp", path) >= PATH_MAX) {
+		printf("Output path too long: %s\n", path);
+		tmp[0] = '\0';
+		return -1;
+	}
+	fd = open(tmp, O_CREAT | O_TRUNC | flags, 0640);
+	if (fd < 0) {
+		printf("Unable to open file %s for memdump\n", tmp);
+		tmp[0] = '\0';
+		return -1;
+	}
+	if (fchmod(fd, 0640) != 0) {
+		printf("Unable to change file permissions for %s\n", tmp);
+		close(fd);
+		unlink(tmp);
+		tmp[0] = '\0';
+		return -1;
+	}
+
+	return fd;
+}
+
+/**
+ * finish_output - put a dump written by open_output in place, or drop it on failure
+ */
+static bool finish_output(const char *path, const char *tmp, bool ok)
+{
+	if (tmp[0] == '\0')
+		return ok;
+
+	if (ok && rename(tmp, path) != 0) {
+		printf("Unable to rename %s to %s\n", tmp, path);
+		ok = false;
+	}
+	if (!ok)
+		unlink(tmp);
+
+	return ok;
+}
+
+/**
+ * dump_record_fd - dump a record to a regular file without stdio
+ */
+static TEEC_Result dump_record_fd(memdump_session_t *session, uint32_t record, uint64_t start, uint64_t length,
+				  int fd, enum memdump_output output, enum memdump_endian convert,
+				  memdump_record_info_t *info)
+{
+	TEEC_Result res;
+	struct stat st;
+
+	if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+		printf("-m and -d need a regular output file\n");
+		return TEEC_ERROR_BAD_PARAMETERS;
+	}
+	if (output == MEMDUMP_OUTPUT_MMAP && ftruncate(fd, length) != 0) {
+		printf("Unable to size memdump output file\n");
+		return TEEC_ERROR_GENERIC;
+	}
+
+	/* Byte start of the record lands at the start of the file */
+	res = adi_memdump_to_fd(session, record, start, length, fd, 0 - start, output, convert, info);
+
+	/* The record may come back shorter than its reported size */
+	if (res == TEEC_SUCCESS && ftruncate(fd, info->size) != 0)
+		res = TEEC_ERROR_GENERIC;
+
+	return res;
+}
+
+/**
+ * delta_sink - memdump_sink_t hashing pages and writing the changed ones
+ */
+static bool delta_sink(void *arg, uint8_t *data, size_t len, uint64_t pos)
+{
+	return memdump_delta_update(arg, data, len, pos);
+}
+
+/**
+ * dump_record_delta - dump the pages of a record that changed since a previous dump
+ *
+ * Changed pages are written to fd in order, and the manifest of this dump to
+ * MEMDUMP_MANIFEST_PATH. Without a base manifest every page is written, which
+ * starts a chain of incremental dumps.
+ */
+static TEEC_Result dump_record_delta(memdump_session_t *session, uint32_t record, uint32_t size,
+				     const char *base_path, int fd, enum memdump_endian convert,
+				     memdump_record_info_t *info)
+{
+	TEEC_Result res = TEEC_ERROR_GENERIC;
+	memdump_manifest_t base;
+	memdump_delta_t delta;
+	bool have_base = false;
+
+	if (access(base_path, F_OK) == 0) {
+		if (!memdump_manifest_load(&base, base_path))
+			return TEEC_ERROR_BAD_FORMAT;
+		have_base = true;
+	} else {
+		printf("No manifest %s, dumping every page\n", base_path);
+	}
+
+	if (!memdump_delta_init(&delta, have_base ? &base : NULL, record, size, fd)) {
+		res = TEEC_ERROR_OUT_OF_MEMORY;
+		goto free_base;
+	}
+
+	res = adi_memdump_stream(session, record, size, convert, delta_sink, &delta, info);
+	if (res == TEEC_SUCCESS) {
+		if (memdump_delta_finish(&delta, info->address, info->size, MEMDUMP_MANIFEST_PATH))
+			printf("0x%llx of 0x%llx pages changed\n", (unsigned long long)delta.manifest.hdr.changed_pages,
+			       (unsigned long long)delta.manifest.hdr.num_pages);
+		else
 			res = TEEC_ERROR_GENERIC;
-			goto end;
+	}
+	memdump_delta_free(&delta);
+
+free_base:
+	if (have_base)
+		memdump_manifest_free(&base);
+
+	return res;
+}
+
+/* Hex view of a record */
+struct view_sink_arg {
+	hexdump_t hd;
+	const memdump_record_info_t *info;      /* Filled in before the first chunk */
+	uint64_t start;
+	bool started;
+};
+
+/**
+ * view_sink - memdump_sink_t formatting a record as hex
+ *
+ * Addresses are annotated from the record base, and words are read in the
+ * record's byte order unless the format says otherwise.
+ */
+static bool view_sink(void *arg, uint8_t *data, size_t len, uint64_t pos)
+{
+	struct view_sink_arg *view = arg;
+
+	if (!view->started) {
+		view->hd.fmt.base = view->info->address + view->start;
+		if (view->hd.fmt.order == HEXDUMP_ORDER_DEFAULT)
+			view->hd.fmt.order = (view->info->endianness == MEMDUMP_ENDIAN_BIG) ? HEXDUMP_ORDER_BIG :
+											     HEXDUMP_ORDER_LITTLE;
+		view->started = true;
+	}
+
+	return hexdump_write(&view->hd, data, len);
+}
+
+/**
+ * view_record - Print a range of a record as hex to fd
+ */
+static TEEC_Result view_record(memdump_session_t *session, uint32_t record, uint64_t start, uint64_t length,
+			       int fd, const memdump_options_t *opts, memdump_record_info_t *info)
+{
+	TEEC_Result res;
+	struct view_sink_arg view = {
+		.info = info,
+		.start = start,
+	};
+
+	if (!hexdump_init(&view.hd, opts->view, fd)) {
+		printf("Invalid hex view format\n");
+		return TEEC_ERROR_BAD_PARAMETERS;
+	}
+
+	res = adi_memdump_stream_range(session, record, start, length, opts->convert, view_sink, &view, info);
+	if (!hexdump_finish(&view.hd) && res == TEEC_SUCCESS)
+		res = TEEC_ERROR_GENERIC;
+
+	return res;
+}
+
+/**
+ * resolve_range - Turn the range asked for in opts into a byte range of the record
+ *
+ * An address range needs the record address up front, from the descriptor
+ * table. The range must lie within the record.
+ */
+static TEEC_Result resolve_range(memdump_session_t *session, uint32_t record, uint32_t size,
+				 const memdump_options_t *opts, uint64_t *start, uint64_t *length)
+{
+	TEEC_Result res;
+	memdump_record_info_t *infos;
+	uint32_t num_records = 0;
+	uint64_t address;
+
+	*start = opts->range_start;
+	if (opts->range_address) {
+		res = adi_memdump_descriptors(session, &infos, &num_records);
+		if (adi_memdump_unknown_cmd(res))
+			printf("The TA cannot report record addresses, select the range by offset\n");
+		if (res != TEEC_SUCCESS)
+			return res;
+		if (record >= num_records) {
+			free(infos);
+			return TEEC_ERROR_BAD_PARAMETERS;
+		}
+		address = infos[record].address;
+		free(infos);
+
+		if (opts->range_start < address || opts->range_start - address > size) {
+			printf("Address 0x%llx is outside record %u at 0x%llx, 0x%x bytes\n",
+			       (unsigned long long)opts->range_start, record, (unsigned long long)address, size);
+			return TEEC_ERROR_BAD_PARAMETERS;
 		}
-		res = fwrite(data, 1, op.params[OP_PARAM_BUFFER].memref.size, fp);
-		if (res != op.params[OP_PARAM_BUFFER].memref.size) {
-			printf("Unable to write to file /tmp/memdump.bin\n");
+		*start = opts->range_start - address;
+	}
+
+	if (*start > size) {
+		printf("Offset 0x%llx is past the end of record %u, 0x%x bytes\n", (unsigned long long)*start, record,
+		       size);
+		return TEEC_ERROR_BAD_PARAMETERS;
+	}
+
+	*length = opts->range_length ? opts->range_length : size - *start;
+	if (*length > size - *start) {
+		printf("Range 0x%llx+0x%llx runs past the end of record %u, 0x%x bytes\n",
+		       (unsigned long long)*start, (unsigned long long)*length, record, size);
+		return TEEC_ERROR_BAD_PARAMETERS;
+	}
+
+	return TEEC_SUCCESS;
+}
+
+/**
+ * adi_memdump - Open a TEE session to dump memory region of specified record
+ *
+ * Only the range of the record selected by opts is fetched from the TA, and
+ * it is written to the output as it arrives. The address printed is that of
+ * the first byte dumped.
+ */
+TEEC_Result adi_memdump(uint64_t record, const memdump_options_t *opts)
+{
+	TEEC_Result res;
+	memdump_session_t session;
+	memdump_record_info_t info;
+	const char *path = opts->path;
+	char tmp[PATH_MAX];
+	FILE *fp;
+	uint32_t size = 0;
+	uint64_t start = 0;
+	uint64_t length = 0;
+	int flags = O_WRONLY;
+	int fd;
+
+	if (path == NULL)
+		path = (opts->view != NULL) ? "-" : MEMDUMP_RECORD_PATH;
+	if (opts->view == NULL && opts->compress == MEMDUMP_COMPRESS_NONE) {
+		/* Read access too, mapping a file needs it even for writing */
+		if (opts->output == MEMDUMP_OUTPUT_MMAP)
+			flags = O_RDWR;
+		else if (opts->output == MEMDUMP_OUTPUT_DIRECT)
+			flags |= O_DIRECT;
+	}
+
+	res = adi_memdump_open_session(&session);
+	if (res != TEEC_SUCCESS)
+		return res;
+
+	res = adi_memdump_record_size(&session, record, &size);
+	if (res != TEEC_SUCCESS)
+		goto end;
+
+	res = resolve_range(&session, record, size, opts, &start, &length);
+	if (res != TEEC_SUCCESS)
+		goto end;
+
+	fd = open_output(path, flags, tmp);
+	if (fd < 0) {
+		res = TEEC_ERROR_GENERIC;
+		goto end;
+	}
+
+	if (opts->base_manifest != NULL) {
+		res = dump_record_delta(&session, record, size, opts->base_manifest, fd, opts->convert, &info);
+	} else if (opts->view != NULL) {
+		res = view_record(&session, record, start, length, fd, opts, &info);
+	} else if (opts->output != MEMDUMP_OUTPUT_STDIO && opts->compress == MEMDUMP_COMPRESS_NONE) {
+		res = dump_record_fd(&session, record, start, length, fd, opts->output, opts->convert, &info);
+	} else {
+		fp = fdopen(fd, "wb");
+		if (fp == NULL) {
+			printf("Unable to open file %s for memdump\n", path);
 			res = TEEC_ERROR_GENERIC;
-			goto end;
+			goto close_fd;
 		}
-		res = fclose(fp);
-		if (res != 0) {
-			printf("Unable to close file /tmp/memdump.bin\n");
+
+		if (opts->compress == MEMDUMP_COMPRESS_NONE)
+			res = adi_memdump_stream_range(&session, record, start, length, opts->convert, file_sink, fp,
+						       &info);
+		else
+			res = adi_memdump_stream_compressed(&session, record, start, length, opts->convert,
+							    opts->compress, file_sink, fp, &info);
+
+		fd = -1;
+		if (fclose(fp) != 0 && res == TEEC_SUCCESS) {
+			printf("Unable to close file %s\n", path);
 			res = TEEC_ERROR_GENERIC;
-			goto end;
 		}
 	}
 
+close_fd:
+	if (fd >= 0 && close(fd) != 0 && res == TEEC_SUCCESS) {
+		printf("Unable to close file %s\n", path);
+		res = TEEC_ERROR_GENERIC;
+	}
+	if (!finish_output(path, tmp, res == TEEC_SUCCESS) && res == TEEC_SUCCESS)
+		res = TEEC_ERROR_GENERIC;
+	if (res == TEEC_SUCCESS && opts->view == NULL)
+		printf("0x%08x 0x%04x 0x%04x 0x%01x\n", (uint32_t)(info.address + start), info.size, info.width,
+		       info.endianness);
+
 end:
-	/* Release shared memory, close the session, and destroy the context */
-	free(data);
-	TEEC_ReleaseSharedMemory(&output_buf);
-	TEEC_CloseSession(&sess);
-	TEEC_FinalizeContext(&ctx);
+	/* Close the session, and destroy the context */
+	adi_memdump_close_session(&session);
+
+	return res;
+}
+
+/* Destination of one record of an all-records dump */
+struct container_sink_arg {
+	memdump_container_t *container;
+	uint32_t index;
+};
+
+/**
+ * container_sink - memdump_sink_t writing a record at its offset in a container
+ */
+static bool container_sink(void *arg, uint8_t *data, size_t len, uint64_t pos)
+{
+	struct container_sink_arg *dst = arg;
+
+	return memdump_container_write(dst->container, dst->index, data, len, pos);
+}
+
+/**
+ * container_append_sink - memdump_sink_t appending a compressed record to a container
+ */
+static bool container_append_sink(void *arg, uint8_t *data, size_t len, uint64_t pos)
+{
+	struct container_sink_arg *dst = arg;
+
+	return memdump_container_append(dst->container, dst->index, data, len);
+}
+
+/**
+ * adi_memdump_all - Dump every record over a single session into a container file
+ *
+ * Records are enumerated once and each record is streamed, or with
+ * MEMDUMP_OUTPUT_MMAP dumped in place, to its offset in the container.
+ * Compressed records are appended one after the other instead. With
+ * opts->jobs above 1, uncompressed records are dumped by parallel workers.
+ * One line per record is printed, as for a single record.
+ */
+TEEC_Result adi_memdump_all(const char *path, const memdump_options_t *opts)
+{
+	enum memdump_output output = opts->output;
+	enum memdump_compress compress = opts->compress;
+	TEEC_Result res;
+	memdump_session_t session;
+	memdump_container_t container;
+	memdump_record_info_t info;
+	memdump_record_info_t *infos = NULL;
+	memdump_record_info_t *descs = NULL;
+	struct container_sink_arg dst;
+	uint32_t num_records = 0;
+	uint64_t *sizes = NULL;
+	bool described;
+
+	res = adi_memdump_open_session(&session);
+	if (res != TEEC_SUCCESS)
+		return res;
+
+	/* Sizes first, to lay out the container */
+	res = describe_records(&session, &descs, &num_records, &described);
+	if (res != TEEC_SUCCESS)
+		goto end;
+
+	sizes = calloc(num_records ? num_records : 1, sizeof(uint64_t));
+	if (sizes == NULL) {
+		res = TEEC_ERROR_OUT_OF_MEMORY;
+		goto end;
+	}
+	for (uint32_t i = 0; i < num_records; i++)
+		sizes[i] = descs[i].size;
+
+	if (compress != MEMDUMP_COMPRESS_NONE)
+		output = MEMDUMP_OUTPUT_STDIO;
+	if (!memdump_container_create(&container, path, output == MEMDUMP_OUTPUT_DIRECT ? O_DIRECT : 0, num_records,
+				      compress == MEMDUMP_COMPRESS_NONE ? sizes : NULL)) {
+		res = TEEC_ERROR_GENERIC;
+		goto end;
+	}
+
+	if (opts->jobs > 1 && compress == MEMDUMP_COMPRESS_NONE) {
+		infos = calloc(num_records ? num_records : 1, sizeof(*infos));
+		if (infos == NULL)
+			res = TEEC_ERROR_OUT_OF_MEMORY;
+		else
+			res = adi_memdump_parallel(&session, &container, opts, infos);
+	}
+
+	dst.container = &container;
+	for (uint32_t i = 0; i < num_records && res == TEEC_SUCCESS; i++) {
+		dst.index = i;
+		if (infos != NULL)
+			info = infos[i];
+		else if (compress != MEMDUMP_COMPRESS_NONE)
+			res = adi_memdump_stream_compressed(&session, i, 0, sizes[i], opts->convert, compress,
+							    container_append_sink, &dst, &info);
+		else if (output == MEMDUMP_OUTPUT_STDIO)
+			res = adi_memdump_stream(&session, i, sizes[i], opts->convert, container_sink, &dst, &info);
+		else
+			res = adi_memdump_to_fd(&session, i, 0, sizes[i], container.fd, container.entries[i].offset,
+						output, opts->convert, &info);
+		if (res != TEEC_SUCCESS) {
+			printf("Unable to dump record %u to %s\n", i, path);
+			break;
+		}
+		printf("0x%08x 0x%04x 0x%04x 0x%01x\n", (uint32_t)info.address, info.size, info.width, info.endianness);
+
+		container.entries[i].address = info.address;
+		container.entries[i].width = info.width;
+		container.entries[i].endianness = info.endianness;
+		container.entries[i].size = info.size;
+		if (compress != MEMDUMP_COMPRESS_NONE)
+			container.entries[i].flags |= MEMDUMP_ENTRY_COMPRESSED;
+	}
+
+	if (!memdump_container_close(&container) && res == TEEC_SUCCESS)
+		res = TEEC_ERROR_GENERIC;
+
+end:
+	free(infos);
+	free(descs);
+	free(sizes);
+	adi_memdump_close_session(&session);
 
 	return res;
 }
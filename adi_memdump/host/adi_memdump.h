@@ -28,9 +28,118 @@
 #ifndef ADI_MEMDUMP_H
 #define ADI_MEMDUMP_H
 
+#include <stdbool.h>
+#include <stdint.h>
 #include <tee_client_api.h>
 
-TEEC_Result adi_memdump(uint64_t record);
+#include "hexdump.h"
+#include "memdump_compress.h"
+#include "memdump_swap.h"
+
+/* Default output of a single record dump, "-" is stdout */
+#define MEMDUMP_RECORD_PATH "/tmp/memdump.bin"
+
+/* Open context and session to the memdump TA, reusable across records */
+typedef struct memdump_session {
+	TEEC_Context ctx;
+	TEEC_Session sess;
+} memdump_session_t;
+
+/* Description of a record, as returned by the TA with its data */
+typedef struct memdump_record_info {
+	uint32_t record;
+	uint32_t size;          /* Bytes */
+	uint64_t address;       /* Address of the first byte */
+	uint32_t width;         /* Access width reported by the TA, bytes: 1, 2, 4 or 8 */
+	uint32_t endianness;    /* Endianness reported by the TA */
+} memdump_record_info_t;
+
+/* Record descriptor, as packed by the TA into the descriptor table, one per record */
+typedef struct memdump_descriptor {
+	uint32_t record;
+	uint32_t size;          /* Bytes */
+	uint32_t width;         /* Bytes: 1, 2, 4 or 8 */
+	uint32_t endianness;
+	uint64_t address;
+} memdump_descriptor_t;
+
+/* Descriptors asked for by the first descriptor table invoke */
+#define MEMDUMP_DESCRIPTORS_HINT 64
+
+TEEC_Result adi_memdump_open_session(memdump_session_t *session);
+void adi_memdump_close_session(memdump_session_t *session);
+bool adi_memdump_unknown_cmd(TEEC_Result res);
+TEEC_Result adi_memdump_num_records(memdump_session_t *session, uint32_t *num_records);
+TEEC_Result adi_memdump_record_size(memdump_session_t *session, uint32_t record, uint32_t *size);
+TEEC_Result adi_memdump_descriptors(memdump_session_t *session, memdump_record_info_t **infos,
+				    uint32_t *num_records);
+TEEC_Result adi_memdump_fetch(memdump_session_t *session, uint32_t record, uint8_t *buf, uint32_t size,
+			      memdump_record_info_t *info);
+
+TEEC_Result adi_memdump_fetch_chunk(memdump_session_t *session, TEEC_SharedMemory *shm, size_t shm_offset,
+				    uint32_t record, uint64_t offset, uint32_t *len, memdump_record_info_t *info);
+
+/* Size of each half of the double-buffered window used to stream a record */
+#define MEMDUMP_CHUNK_SIZE (256 * 1024)
+
+/*
+ * Consumer of a streamed record. Called in order of pos, from a writer
+ * thread, with len bytes of the record starting at byte pos. The sink owns
+ * data until it returns and may modify it in place. Returning false aborts
+ * the dump.
+ */
+typedef bool (*memdump_sink_t)(void *arg, uint8_t *data, size_t len, uint64_t pos);
+
+TEEC_Result adi_memdump_stream_range(memdump_session_t *session, uint32_t record, uint64_t start, uint64_t length,
+				     enum memdump_endian convert, memdump_sink_t sink, void *arg,
+				     memdump_record_info_t *info);
+TEEC_Result adi_memdump_stream(memdump_session_t *session, uint32_t record, uint64_t size,
+			       enum memdump_endian convert, memdump_sink_t sink, void *arg, memdump_record_info_t *info);
+
+TEEC_Result adi_memdump_stream_compressed(memdump_session_t *session, uint32_t record, uint64_t start,
+					  uint64_t length, enum memdump_endian convert, enum memdump_compress compress, memdump_sink_t sink,
+					  void *arg, memdump_record_info_t *info);
+
+/* How record data gets from the TA to the output file */
+enum memdump_output {
+	MEMDUMP_OUTPUT_STDIO,   /* Streamed through the window, then written */
+	MEMDUMP_OUTPUT_MMAP,    /* TA writes straight into the mapped output file */
+	MEMDUMP_OUTPUT_DIRECT,  /* Streamed through the window, written with O_DIRECT */
+};
+
+/* Size of the output file window mapped and registered at a time */
+#define MEMDUMP_MAP_CHUNK_SIZE (4 * 1024 * 1024)
+
+/* Buffer, offset and length alignment for O_DIRECT writes */
+#define MEMDUMP_DIRECT_ALIGN 4096
+
+TEEC_Result adi_memdump_mmap(memdump_session_t *session, uint32_t record, uint64_t start, uint64_t length, int fd,
+			     uint64_t offset, enum memdump_endian convert, memdump_record_info_t *info);
+TEEC_Result adi_memdump_to_fd(memdump_session_t *session, uint32_t record, uint64_t start, uint64_t length, int fd,
+			      uint64_t offset, enum memdump_output output, enum memdump_endian convert,
+			      memdump_record_info_t *info);
+
+/* How adi_memdump() and adi_memdump_all() dump records */
+typedef struct memdump_options {
+	enum memdump_output output;
+	enum memdump_compress compress;
+	const char *base_manifest;      /* Incremental dump against this manifest, NULL for a full dump */
+	uint32_t jobs;                  /* Workers for adi_memdump_all(), 0 or 1 for serial */
+	enum memdump_endian convert;
+	uint64_t range_start;           /* Byte offset in the record, or address if range_address */
+	uint64_t range_length;          /* Bytes from range_start, 0 for the rest of the record */
+	bool range_address;
+	const hexdump_format_t *view;   /* Print as hex instead of writing the bytes, NULL for binary */
+	const char *path;               /* Output of a single record, NULL for the default */
+} memdump_options_t;
+
+struct memdump_container;
+TEEC_Result adi_memdump_parallel(memdump_session_t *session, struct memdump_container *container,
+				 const memdump_options_t *opts, memdump_record_info_t *infos);
+
+TEEC_Result adi_memdump(uint64_t record, const memdump_options_t *opts);
 TEEC_Result adi_memdump_get_num_records(void);
+TEEC_Result adi_memdump_list(void);
+TEEC_Result adi_memdump_all(const char *path, const memdump_options_t *opts);
 
 #endif /* ADI_MEMDUMP_H */
@@ -27,40 +27,213 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
 
 #include "adi_memdump.h"
-
-/* Command line arguments */
-#define ARG_RECORD 1
+#include "memdump_container.h"
 
 /* Command help */
 #define HELP "\n\
-Usage:  [record number] \n\
+Usage:  [-m | -d | -c mode | -x format] [-e order] [-s offset | -A address] \n\
+        [-n length] [-o output] [record number] \n\
+        [-m | -d | -c mode] [-e order] [-j jobs] -a [file] \n\
+        [-e order] [-o output] -i manifest record number \n\
+        -l \n\
+        -B \n\
   - record number: number of record to memdump to /tmp/memdump.bin \n\
+  - -o: write the record to output instead, '-' for stdout; it is written \n\
+    as it is dumped, and with '-' everything else is printed to stderr \n\
   - if record number not provided, will return total number of records \n\
+  - -a: dump all records over one session into an indexed container file \n\
+    (default /tmp/memdump.adm) \n\
+  - -m: let the TA write straight into the mapped output file \n\
+  - -d: write the output file with O_DIRECT, for very large dumps \n\
+  - -c: compress while dumping, mode 'lz4' or 'zero' (zero page elision \n\
+    only); read the output back with optee_app_adi_memdump_extract \n\
+  - -j: dump records with up to jobs workers, each with its own session \n\
+  - -i: incremental dump, write only the pages that changed since the dump \n\
+    described by manifest to the output, and the manifest of this \n\
+    dump to /tmp/memdump.idx; without manifest every page is written \n\
+  - -e: convert multi-byte words to order 'host', 'little' or 'big' while \n\
+    dumping, by the access width in bytes the TA reports for the record; \n\
+    a record whose width is not 1, 2, 4 or 8, or a -s or -A start inside \n\
+    a word, is not dumped \n\
+  - -s, -A: dump from byte offset of the record, or from an absolute \n\
+    address within it, instead of from its start \n\
+  - -n: dump length bytes only, instead of up to the end of the record \n\
+  - -x: print the record as hex, to stdout unless -o is given, \n\
+    format 'width[:little|big]' with width 1, 2, 4 or 8 bytes per word, \n\
+    words read in the record's byte order by default \n\
+  - -l: list every record's address, size, width and endianness, and the \n\
+    size of a container of them all, without dumping any \n\
+  - -B: benchmark the byte swap used by -e against the scalar loop, no TA \n\
+    session is opened \n\
 \n"
 
+/* Byte swap benchmark buffer */
+#define BENCH_SIZE (64 * 1024 * 1024)
+#define BENCH_ROUNDS 4
+
 bool parse_value32(char *data, uint32_t *value);
+bool parse_value64(char *data, uint64_t *value);
 
 /* MAIN */
 int main(int argc, char *argv[])
 {
+	memdump_options_t opts = {
+		.output = MEMDUMP_OUTPUT_STDIO,
+		.compress = MEMDUMP_COMPRESS_NONE,
+		.convert = MEMDUMP_CONVERT_NONE,
+	};
 	uint32_t cmd_record_num = 0;
-	int res = 1;
+	bool all = false;
+	bool list = false;
+	bool ranged = false;
+	hexdump_format_t view;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "amdc:e:i:j:lBs:A:n:o:x:")) != -1) {
+		switch (opt) {
+		case 'a':
+			all = true;
+			break;
+		case 'm':
+			opts.output = MEMDUMP_OUTPUT_MMAP;
+			break;
+		case 'd':
+			opts.output = MEMDUMP_OUTPUT_DIRECT;
+			break;
+		case 'c':
+			if (strcmp(optarg, "lz4") == 0) {
+				opts.compress = MEMDUMP_COMPRESS_LZ4;
+			} else if (strcmp(optarg, "zero") == 0) {
+				opts.compress = MEMDUMP_COMPRESS_ZERO;
+			} else {
+				printf("Invalid compression mode '%s'.\n", optarg);
+				return 1;
+			}
+			break;
+		case 'e':
+			if (strcmp(optarg, "host") == 0) {
+				opts.convert = MEMDUMP_CONVERT_HOST;
+			} else if (strcmp(optarg, "little") == 0) {
+				opts.convert = MEMDUMP_CONVERT_LITTLE;
+			} else if (strcmp(optarg, "big") == 0) {
+				opts.convert = MEMDUMP_CONVERT_BIG;
+			} else {
+				printf("Invalid byte order '%s'.\n", optarg);
+				return 1;
+			}
+			break;
+		case 'i':
+			opts.base_manifest = optarg;
+			break;
+		case 'j':
+			if (!parse_value32(optarg, &opts.jobs) || opts.jobs == 0) {
+				printf("Invalid number of jobs '%s'.\n", optarg);
+				return 1;
+			}
+			break;
+		case 'l':
+			list = true;
+			break;
+		case 's':
+		case 'A':
+			if (!parse_value64(optarg, &opts.range_start)) {
+				printf("Invalid start '%s'.\n", optarg);
+				return 1;
+			}
+			opts.range_address = (opt == 'A');
+			ranged = true;
+			break;
+		case 'o':
+			opts.path = optarg;
+			break;
+		case 'x':
+			hexdump_format_init(&view);
+			if (!hexdump_parse_format(optarg, &view)) {
+				printf("Invalid hex view format '%s'.\n", optarg);
+				return 1;
+			}
+			opts.view = &view;
+			break;
+		case 'n':
+			if (!parse_value64(optarg, &opts.range_length) || opts.range_length == 0) {
+				printf("Invalid length '%s'.\n", optarg);
+				return 1;
+			}
+			ranged = true;
+			break;
+		case 'B':
+			return memdump_bswap_benchmark(BENCH_SIZE, BENCH_ROUNDS) ? 0 : 1;
+		default:
+			printf(HELP);
+			return 1;
+		}
+	}
+
+	/* Compressed output is streamed, its size is not known up front */
+	if (opts.compress != MEMDUMP_COMPRESS_NONE && opts.output != MEMDUMP_OUTPUT_STDIO) {
+		printf("Compression cannot be combined with -m or -d.\n");
+		return 1;
+	}
+	if (opts.base_manifest != NULL &&
+	    (all || opts.compress != MEMDUMP_COMPRESS_NONE || opts.output != MEMDUMP_OUTPUT_STDIO)) {
+		printf("Incremental dumps are of a single record, without -m, -d or -c.\n");
+		return 1;
+	}
+	if (opts.path != NULL && (all || list)) {
+		printf("-o is the output of a single record, give -a its file as argument.\n");
+		return 1;
+	}
+	if (opts.path != NULL && strcmp(opts.path, "-") == 0 && opts.output != MEMDUMP_OUTPUT_STDIO) {
+		printf("-m and -d need a regular output file, not stdout.\n");
+		return 1;
+	}
+	if (opts.view != NULL && (all || list || opts.base_manifest != NULL || opts.output != MEMDUMP_OUTPUT_STDIO ||
+				  opts.compress != MEMDUMP_COMPRESS_NONE)) {
+		printf("The hex view is of a single record, without -a, -l, -i, -m, -d or -c.\n");
+		return 1;
+	}
+	if (ranged && (all || list || opts.base_manifest != NULL)) {
+		printf("A range is dumped from a single record, without -a, -l or -i.\n");
+		return 1;
+	}
+	if (opts.jobs > 1 && opts.compress != MEMDUMP_COMPRESS_NONE) {
+		printf("Compressed records are appended in order, -j cannot be combined with -c.\n");
+		return 1;
+	}
 
-	if (argc == 1) {
+	if (list) {
+		/* Describe the records, dump nothing */
+		if (all || argc != optind || opts.base_manifest != NULL) {
+			printf(HELP);
+			return 1;
+		}
+		if (adi_memdump_list() != TEEC_SUCCESS)
+			return 1;
+		else
+			return 0;
+	} else if (all && argc - optind <= 1) {
+		/* Dump every record into one container */
+		if (adi_memdump_all(optind < argc ? argv[optind] : MEMDUMP_CONTAINER_PATH, &opts) != TEEC_SUCCESS)
+			return 1;
+		else
+			return 0;
+	} else if (!all && argc == optind) {
 		/* If no additional arguments, get number of records */
 		if (adi_memdump_get_num_records() != TEEC_SUCCESS)
 			return 1;
 		else
 			return 0;
-	} else if (argc == 2) {
+	} else if (!all && argc - optind == 1) {
 		/* If record number provided, get memdump for record */
-		if (!parse_value32(argv[ARG_RECORD], &cmd_record_num)) {
-			printf("Invalid record number '%s'.\n", argv[ARG_RECORD]);
+		if (!parse_value32(argv[optind], &cmd_record_num)) {
+			printf("Invalid record number '%s'.\n", argv[optind]);
 			return 1;
 		}
-		if (adi_memdump(cmd_record_num) != TEEC_SUCCESS)
+		if (adi_memdump(cmd_record_num, &opts) != TEEC_SUCCESS)
 			return 1;
 		else
 			return 0;
@@ -83,3 +256,15 @@ bool parse_value32(char *data, uint32_t *value)
 	if (*end != '\0') return 0;
 	return 1;
 }
+
+/**
+ * parse_value64 - gets uint64_t from string
+ */
+bool parse_value64(char *data, uint64_t *value)
+{
+	char *end;
+
+	*value = strtoull(data, &end, 0);
+	if (*end != '\0') return 0;
+	return 1;
+}
@@ -0,0 +1,327 @@
+/*
+ * Copyright (c) 2026, Analog Devices Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "memdump_compress.h"
+
+/* LZ4 block format limits */
+#define LZ4_MIN_MATCH 4
+#define LZ4_LAST_LITERALS 5
+#define LZ4_MFLIMIT 12
+#define LZ4_MAX_OFFSET 65535
+#define LZ4_HASH_BITS 12
+
+/**
+ * lz4_bound - worst case size of an LZ4 block of len input bytes
+ */
+static size_t lz4_bound(size_t len)
+{
+	return len + len / 255 + 16;
+}
+
+/**
+ * lz4_hash - hash the 4 bytes at p into the match finder table
+ */
+static uint32_t lz4_hash(const uint8_t *p)
+{
+	uint32_t v;
+
+	memcpy(&v, p, sizeof(v));
+	return (v * 2654435761u) >> (32 - LZ4_HASH_BITS);
+}
+
+/**
+ * lz4_length - write the extra length bytes of a literal or match length
+ */
+static uint8_t *lz4_length(uint8_t *op, size_t len)
+{
+	while (len >= 255) {
+		*op++ = 255;
+		len -= 255;
+	}
+	*op++ = len;
+
+	return op;
+}
+
+/**
+ * lz4_sequence - write one sequence of literals and an optional match
+ */
+static uint8_t *lz4_sequence(uint8_t *op, const uint8_t *lit, size_t lit_len, size_t offset, size_t match_len)
+{
+	uint8_t *token = op++;
+
+	*token = (lit_len >= 15 ? 15 : lit_len) << 4;
+	if (lit_len >= 15)
+		op = lz4_length(op, lit_len - 15);
+	memcpy(op, lit, lit_len);
+	op += lit_len;
+
+	if (match_len == 0)
+		return op;
+
+	*op++ = offset;
+	*op++ = offset >> 8;
+	match_len -= LZ4_MIN_MATCH;
+	*token |= match_len >= 15 ? 15 : match_len;
+	if (match_len >= 15)
+		op = lz4_length(op, match_len - 15);
+
+	return op;
+}
+
+/**
+ * lz4_compress - greedy single pass LZ4 block compressor
+ *
+ * dst must hold lz4_bound(len) bytes. Returns the compressed size.
+ */
+static size_t lz4_compress(uint32_t *table, const uint8_t *src, size_t len, uint8_t *dst)
+{
+	const uint8_t *ip = src;
+	const uint8_t *anchor = src;
+	const uint8_t *match_limit = src + len - LZ4_LAST_LITERALS;
+	const uint8_t *ref;
+	uint8_t *op = dst;
+	size_t match_len;
+	uint32_t h;
+
+	if (len < LZ4_MFLIMIT + 1)
+		return lz4_sequence(op, src, len, 0, 0) - dst;
+
+	memset(table, 0, sizeof(uint32_t) << LZ4_HASH_BITS);
+
+	while (ip < src + len - LZ4_MFLIMIT) {
+		h = lz4_hash(ip);
+		ref = src + table[h];
+		table[h] = ip - src;
+		if (ref >= ip || ip - ref > LZ4_MAX_OFFSET || memcmp(ref, ip, LZ4_MIN_MATCH) != 0) {
+			ip++;
+			continue;
+		}
+
+		/* Extend the match, leaving the last literals alone */
+		match_len = LZ4_MIN_MATCH;
+		while (ip + match_len < match_limit && ref[match_len] == ip[match_len])
+			match_len++;
+
+		op = lz4_sequence(op, anchor, ip - anchor, ip - ref, match_len);
+		ip += match_len;
+		anchor = ip;
+	}
+
+	return lz4_sequence(op, anchor, src + len - anchor, 0, 0) - dst;
+}
+
+/**
+ * memdump_decompress_lz4 - decode an LZ4 block of exactly dst_len bytes
+ */
+bool memdump_decompress_lz4(const uint8_t *src, size_t src_len, uint8_t *dst, size_t dst_len)
+{
+	const uint8_t *ip = src;
+	const uint8_t *iend = src + src_len;
+	uint8_t *op = dst;
+	uint8_t *oend = dst + dst_len;
+	size_t lit_len, match_len, offset;
+	uint8_t token, b;
+
+	while (ip < iend) {
+		token = *ip++;
+
+		lit_len = token >> 4;
+		if (lit_len == 15) {
+			do {
+				if (ip >= iend)
+					return false;
+				b = *ip++;
+				lit_len += b;
+			} while (b == 255);
+		}
+		if (lit_len > (size_t)(iend - ip) || lit_len > (size_t)(oend - op))
+			return false;
+		memcpy(op, ip, lit_len);
+		ip += lit_len;
+		op += lit_len;
+
+		/* The last sequence has no match */
+		if (ip == iend)
+			break;
+
+		if (iend - ip < 2)
+			return false;
+		offset = ip[0] | (ip[1] << 8);
+		ip += 2;
+		if (offset == 0 || offset > (size_t)(op - dst))
+			return false;
+
+		match_len = token & 15;
+		if (match_len == 15) {
+			do {
+				if (ip >= iend)
+					return false;
+				b = *ip++;
+				match_len += b;
+			} while (b == 255);
+		}
+		match_len += LZ4_MIN_MATCH;
+		if (match_len > (size_t)(oend - op))
+			return false;
+
+		/* Byte by byte, matches may overlap their own output */
+		for (size_t i = 0; i < match_len; i++, op++)
+			*op = op[-offset];
+	}
+
+	return op == oend;
+}
+
+/**
+ * memdump_compressor_init - allocate a compressor for chunks of up to max_len bytes
+ */
+bool memdump_compressor_init(memdump_compressor_t *c, enum memdump_compress mode, size_t max_len)
+{
+	memset(c, 0, sizeof(*c));
+	c->mode = mode;
+	c->max_len = max_len;
+
+	/* Worst case: alternating zero and data pages, each with a header */
+	c->out_size = lz4_bound(max_len) + (max_len / MEMDUMP_ZERO_PAGE_SIZE + 2) * sizeof(memdump_block_header_t) +
+		      sizeof(memdump_stream_header_t);
+	c->out = malloc(c->out_size);
+	if (mode == MEMDUMP_COMPRESS_LZ4)
+		c->table = malloc(sizeof(uint32_t) << LZ4_HASH_BITS);
+	if (c->out == NULL || (mode == MEMDUMP_COMPRESS_LZ4 && c->table == NULL)) {
+		memdump_compressor_free(c);
+		return false;
+	}
+
+	return true;
+}
+
+/**
+ * memdump_compressor_free - release the compressor buffers
+ */
+void memdump_compressor_free(memdump_compressor_t *c)
+{
+	free(c->table);
+	free(c->out);
+	memset(c, 0, sizeof(*c));
+}
+
+/**
+ * block - write a block header at dst
+ */
+static uint8_t *block(uint8_t *dst, uint32_t type, size_t raw_size, size_t stored_size)
+{
+	memdump_block_header_t hdr = {
+		.type = type,
+		.raw_size = raw_size,
+		.stored_size = stored_size,
+	};
+
+	memcpy(dst, &hdr, sizeof(hdr));
+
+	return dst + sizeof(hdr);
+}
+
+/**
+ * is_zero - check whether len bytes at p are all zero
+ */
+static bool is_zero(const uint8_t *p, size_t len)
+{
+	return len == 0 || (p[0] == 0 && memcmp(p, p + 1, len - 1) == 0);
+}
+
+/**
+ * memdump_compress_begin - put the stream header in c->out, returns its size
+ */
+size_t memdump_compress_begin(memdump_compressor_t *c)
+{
+	memdump_stream_header_t hdr = {
+		.magic = MEMDUMP_STREAM_MAGIC,
+		.version = MEMDUMP_STREAM_VERSION,
+		.compress = c->mode,
+	};
+
+	memcpy(c->out, &hdr, sizeof(hdr));
+
+	return sizeof(hdr);
+}
+
+/**
+ * memdump_compress - compress the next len bytes of a record into c->out
+ *
+ * The chunk is cut at page boundaries into runs of zero and non-zero pages.
+ * Returns the number of bytes of blocks in c->out.
+ */
+size_t memdump_compress(memdump_compressor_t *c, const uint8_t *src, size_t len)
+{
+	uint8_t *op = c->out;
+	size_t pos = 0;
+	size_t run, page, n;
+	bool zero;
+
+	while (pos < len) {
+		/* Grow a run of pages of the same kind */
+		page = (len - pos < MEMDUMP_ZERO_PAGE_SIZE) ? len - pos : MEMDUMP_ZERO_PAGE_SIZE;
+		zero = is_zero(src + pos, page);
+		run = page;
+		while (pos + run < len) {
+			page = (len - pos - run < MEMDUMP_ZERO_PAGE_SIZE) ? len - pos - run : MEMDUMP_ZERO_PAGE_SIZE;
+			if (is_zero(src + pos + run, page) != zero)
+				break;
+			run += page;
+		}
+
+		if (zero) {
+			op = block(op, MEMDUMP_BLOCK_ZERO, run, 0);
+		} else {
+			n = run;
+			if (c->mode == MEMDUMP_COMPRESS_LZ4)
+				n = lz4_compress(c->table, src + pos, run, op + sizeof(memdump_block_header_t));
+			if (n < run) {
+				op = block(op, MEMDUMP_BLOCK_LZ4, run, n) + n;
+			} else {
+				op = block(op, MEMDUMP_BLOCK_RAW, run, run);
+				memcpy(op, src + pos, run);
+				op += run;
+			}
+		}
+		pos += run;
+	}
+
+	return op - c->out;
+}
+
+/**
+ * memdump_compress_end - put the end block in c->out, returns its size
+ */
+size_t memdump_compress_end(memdump_compressor_t *c)
+{
+	return block(c->out, MEMDUMP_BLOCK_END, 0, 0) - c->out;
+}
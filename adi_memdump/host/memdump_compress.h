@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2026, Analog Devices Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef MEMDUMP_COMPRESS_H
+#define MEMDUMP_COMPRESS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Compressed record stream:
+ *
+ *   memdump_stream_header_t
+ *   blocks, each a memdump_block_header_t followed by stored_size bytes
+ *   MEMDUMP_BLOCK_END block
+ *
+ * Runs of all-zero pages are elided to a ZERO block. Other data is stored
+ * as an LZ4 block (LZ4 block format, without the frame) or RAW when it does
+ * not compress.
+ */
+#define MEMDUMP_STREAM_MAGIC 0x5a4d4441         /* "ADMZ" */
+#define MEMDUMP_STREAM_VERSION 1
+#define MEMDUMP_ZERO_PAGE_SIZE 4096
+
+enum memdump_compress {
+	MEMDUMP_COMPRESS_NONE,
+	MEMDUMP_COMPRESS_ZERO,  /* Zero page elision only */
+	MEMDUMP_COMPRESS_LZ4,   /* Zero page elision and LZ4 */
+};
+
+enum memdump_block_type {
+	MEMDUMP_BLOCK_END,
+	MEMDUMP_BLOCK_RAW,
+	MEMDUMP_BLOCK_ZERO,
+	MEMDUMP_BLOCK_LZ4,
+};
+
+typedef struct memdump_stream_header {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t compress;      /* enum memdump_compress */
+	uint32_t reserved;
+} memdump_stream_header_t;
+
+typedef struct memdump_block_header {
+	uint32_t type;          /* enum memdump_block_type */
+	uint32_t raw_size;      /* Bytes of record data */
+	uint32_t stored_size;   /* Bytes following the header */
+	uint32_t reserved;
+} memdump_block_header_t;
+
+/* Compressor state, reused across the chunks of a record */
+typedef struct memdump_compressor {
+	enum memdump_compress mode;
+	size_t max_len;         /* Largest chunk memdump_compress() accepts */
+	uint32_t *table;        /* LZ4 match finder */
+	uint8_t *out;
+	size_t out_size;
+} memdump_compressor_t;
+
+bool memdump_compressor_init(memdump_compressor_t *c, enum memdump_compress mode, size_t max_len);
+void memdump_compressor_free(memdump_compressor_t *c);
+size_t memdump_compress_begin(memdump_compressor_t *c);
+size_t memdump_compress(memdump_compressor_t *c, const uint8_t *src, size_t len);
+size_t memdump_compress_end(memdump_compressor_t *c);
+
+bool memdump_decompress_lz4(const uint8_t *src, size_t src_len, uint8_t *dst, size_t dst_len);
+
+#endif /* MEMDUMP_COMPRESS_H */
@@ -0,0 +1,224 @@
+/*
+ * Copyright (c) 2026, Analog Devices Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/* O_DIRECT */
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "memdump_container.h"
+
+/**
+ * align_up - round up to the container alignment
+ */
+static uint64_t align_up(uint64_t value)
+{
+	return (value + MEMDUMP_CONTAINER_ALIGN - 1) & ~(uint64_t)(MEMDUMP_CONTAINER_ALIGN - 1);
+}
+
+/**
+ * write_all - pwrite a whole buffer, retrying short writes
+ */
+static bool write_all(int fd, const void *data, size_t len, uint64_t offset)
+{
+	const uint8_t *p = data;
+	ssize_t n;
+
+	while (len > 0) {
+		n = pwrite(fd, p, len, offset);
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n <= 0)
+			return false;
+		p += n;
+		len -= n;
+		offset += n;
+	}
+
+	return true;
+}
+
+/**
+ * memdump_container_size - file size of an uncompressed container of these records
+ */
+uint64_t memdump_container_size(uint32_t num_records, const uint64_t *sizes)
+{
+	uint64_t offset;
+
+	offset = align_up(sizeof(memdump_container_header_t) + num_records * sizeof(memdump_container_entry_t));
+	for (uint32_t i = 0; i < num_records; i++)
+		offset = align_up(offset + sizes[i]);
+
+	return offset;
+}
+
+/**
+ * memdump_container_create - create a container and lay out its records
+ *
+ * Record data offsets are fixed up front from the record sizes, so records
+ * can be written in any order, and the file is sized to hold them all so
+ * records can be written through a mapping. With sizes NULL, records are
+ * instead appended one after the other with memdump_container_append(). flags
+ * are extra open(2) flags, e.g. O_DIRECT. The caller fills in the remaining
+ * fields of container->entries[] before closing.
+ */
+bool memdump_container_create(memdump_container_t *container, const char *path, int flags, uint32_t num_records,
+			      const uint64_t *sizes)
+{
+	uint64_t offset;
+
+	memset(container, 0, sizeof(*container));
+
+	container->entries = calloc(num_records ? num_records : 1, sizeof(memdump_container_entry_t));
+	if (container->entries == NULL)
+		return false;
+	container->num_records = num_records;
+
+	offset = align_up(sizeof(memdump_container_header_t) + num_records * sizeof(memdump_container_entry_t));
+	for (uint32_t i = 0; i < num_records; i++) {
+		container->entries[i].record = i;
+		if (sizes == NULL)
+			continue;
+		container->entries[i].size = sizes[i];
+		container->entries[i].stored_size = sizes[i];
+		container->entries[i].offset = offset;
+		offset = align_up(offset + sizes[i]);
+	}
+	container->end = offset;
+
+	/* Read access too, mapping a file needs it even for writing */
+	container->fd = open(path, O_RDWR | O_CREAT | O_TRUNC | flags, 0640);
+	if (container->fd < 0) {
+		printf("Unable to open file %s\n", path);
+		free(container->entries);
+		container->entries = NULL;
+		return false;
+	}
+
+	if (ftruncate(container->fd, offset) != 0) {
+		printf("Unable to size file %s\n", path);
+		close(container->fd);
+		free(container->entries);
+		container->entries = NULL;
+		return false;
+	}
+
+	return true;
+}
+
+/**
+ * memdump_container_write - write len bytes of a record at byte pos of its data
+ */
+bool memdump_container_write(memdump_container_t *container, uint32_t index, const void *data, size_t len,
+			     uint64_t pos)
+{
+	memdump_container_entry_t *entry;
+
+	if (index >= container->num_records)
+		return false;
+	entry = &container->entries[index];
+	if (pos > entry->size || len > entry->size - pos)
+		return false;
+
+	return write_all(container->fd, data, len, entry->offset + pos);
+}
+
+/**
+ * memdump_container_append - append len bytes to the stored data of a record
+ *
+ * Records are appended one at a time; the first append of a record starts it
+ * at the next aligned offset.
+ */
+bool memdump_container_append(memdump_container_t *container, uint32_t index, const void *data, size_t len)
+{
+	memdump_container_entry_t *entry;
+
+	if (index >= container->num_records)
+		return false;
+	entry = &container->entries[index];
+	if (entry->offset == 0)
+		entry->offset = align_up(container->end);
+
+	if (!write_all(container->fd, data, len, entry->offset + entry->stored_size))
+		return false;
+	entry->stored_size += len;
+	container->end = entry->offset + entry->stored_size;
+
+	return true;
+}
+
+/**
+ * memdump_container_close - write the header and record table, and close
+ */
+bool memdump_container_close(memdump_container_t *container)
+{
+	memdump_container_header_t hdr;
+	uint64_t end = 0;
+	int flags;
+	bool ok;
+
+	memset(&hdr, 0, sizeof(hdr));
+	hdr.magic = MEMDUMP_CONTAINER_MAGIC;
+	hdr.version = MEMDUMP_CONTAINER_VERSION;
+	hdr.num_records = container->num_records;
+	hdr.entry_size = sizeof(memdump_container_entry_t);
+	hdr.data_offset = align_up(sizeof(hdr) + container->num_records * sizeof(memdump_container_entry_t));
+
+	for (uint32_t i = 0; i < container->num_records; i++) {
+		if (!(container->entries[i].flags & MEMDUMP_ENTRY_COMPRESSED))
+			container->entries[i].stored_size = container->entries[i].size;
+		if (container->entries[i].offset + container->entries[i].stored_size > end)
+			end = container->entries[i].offset + container->entries[i].stored_size;
+	}
+
+	/* The index is not block aligned */
+	flags = fcntl(container->fd, F_GETFL);
+	if (flags >= 0 && (flags & O_DIRECT))
+		fcntl(container->fd, F_SETFL, flags & ~O_DIRECT);
+
+	ok = write_all(container->fd, &hdr, sizeof(hdr), 0) &&
+	     write_all(container->fd, container->entries,
+		       container->num_records * sizeof(memdump_container_entry_t), sizeof(hdr)) &&
+	     ftruncate(container->fd, (end > hdr.data_offset) ? end : hdr.data_offset) == 0;
+	if (!ok)
+		printf("Unable to write container index\n");
+
+	if (close(container->fd) != 0) {
+		printf("Unable to close container\n");
+		ok = false;
+	}
+	free(container->entries);
+	memset(container, 0, sizeof(*container));
+	container->fd = -1;
+
+	return ok;
+}
@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2026, Analog Devices Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef MEMDUMP_CONTAINER_H
+#define MEMDUMP_CONTAINER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Container of several memdump records, laid out for mmap:
+ *
+ *   memdump_container_header_t
+ *   memdump_container_entry_t  entries[num_records]
+ *   padding to MEMDUMP_CONTAINER_ALIGN
+ *   record data, each starting at a MEMDUMP_CONTAINER_ALIGN aligned offset
+ *
+ * Analysis tools map the file, read the table and seek straight to a record.
+ * A compressed record holds a memdump_compress.h stream of stored_size
+ * bytes instead of the raw data.
+ */
+#define MEMDUMP_CONTAINER_MAGIC 0x444d4441      /* "ADMD" */
+#define MEMDUMP_CONTAINER_VERSION 1
+#define MEMDUMP_CONTAINER_ALIGN 4096
+#define MEMDUMP_CONTAINER_PATH "/tmp/memdump.adm"
+
+/* memdump_container_entry_t flags */
+#define MEMDUMP_ENTRY_COMPRESSED 0x1
+
+typedef struct memdump_container_header {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t num_records;
+	uint32_t entry_size;    /* sizeof(memdump_container_entry_t) */
+	uint64_t data_offset;   /* Offset of the first record data */
+	uint64_t reserved;
+} memdump_container_header_t;
+
+typedef struct memdump_container_entry {
+	uint32_t record;
+	uint32_t width;
+	uint32_t endianness;
+	uint32_t flags;
+	uint64_t address;
+	uint64_t size;          /* Bytes of record data */
+	uint64_t offset;        /* File offset of the record data */
+	uint64_t stored_size;   /* Bytes at offset, differs from size if compressed */
+} memdump_container_entry_t;
+
+/* A container being written */
+typedef struct memdump_container {
+	int fd;
+	uint32_t num_records;
+	uint64_t end;           /* End of the data appended so far */
+	memdump_container_entry_t *entries;
+} memdump_container_t;
+
+uint64_t memdump_container_size(uint32_t num_records, const uint64_t *sizes);
+bool memdump_container_create(memdump_container_t *container, const char *path, int flags, uint32_t num_records,
+			      const uint64_t *sizes);
+bool memdump_container_write(memdump_container_t *container, uint32_t index, const void *data, size_t len,
+			     uint64_t pos);
+bool memdump_container_append(memdump_container_t *container, uint32_t index, const void *data, size_t len);
+bool memdump_container_close(memdump_container_t *container);
+
+#endif /* MEMDUMP_CONTAINER_H */
@@ -0,0 +1,380 @@
+/*
+ * Copyright (c) 2026, Analog Devices Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "memdump_delta.h"
+
+#define HASH_PRIME1 0x9e3779b185ebca87ULL
+#define HASH_PRIME2 0xc2b2ae3d27d4eb4fULL
+#define HASH_PRIME3 0x165667b19e3779f9ULL
+
+/**
+ * hash_round - fold one 64-bit word into a hash lane
+ */
+static uint64_t hash_round(uint64_t acc, uint64_t v)
+{
+	acc += v * HASH_PRIME2;
+	acc = (acc << 31) | (acc >> 33);
+
+	return acc * HASH_PRIME1;
+}
+
+/**
+ * memdump_page_hash - fast non-cryptographic 64-bit hash of a page
+ *
+ * Four independent lanes over 32 byte blocks keep the multipliers busy. The
+ * length is part of the hash, so a short last page never matches a full one.
+ */
+uint64_t memdump_page_hash(const uint8_t *data, size_t len)
+{
+	uint64_t lane[4] = { HASH_PRIME1 + HASH_PRIME2, HASH_PRIME2, 0, -HASH_PRIME1 };
+	uint64_t h, v;
+	size_t i = 0;
+
+	for (; i + 32 <= len; i += 32) {
+		for (int k = 0; k < 4; k++) {
+			memcpy(&v, data + i + 8 * k, sizeof(v));
+			lane[k] = hash_round(lane[k], v);
+		}
+	}
+
+	h = ((lane[0] << 1) | (lane[0] >> 63)) + ((lane[1] << 7) | (lane[1] >> 57)) +
+	    ((lane[2] << 12) | (lane[2] >> 52)) + ((lane[3] << 18) | (lane[3] >> 46));
+	h += len * HASH_PRIME3;
+
+	for (; i < len; i++)
+		h = ((h ^ data[i]) * HASH_PRIME1) ^ (h >> 29);
+
+	/* Final avalanche */
+	h ^= h >> 33;
+	h *= HASH_PRIME2;
+	h ^= h >> 29;
+	h *= HASH_PRIME3;
+	h ^= h >> 32;
+
+	return h;
+}
+
+/**
+ * io_all - read or write a whole buffer at offset, retrying short transfers
+ */
+static bool io_all(int fd, void *data, size_t len, int64_t offset, bool write_op)
+{
+	uint8_t *p = data;
+	ssize_t n;
+
+	while (len > 0) {
+		if (write_op)
+			n = (offset < 0) ? write(fd, p, len) : pwrite(fd, p, len, offset);
+		else
+			n = (offset < 0) ? read(fd, p, len) : pread(fd, p, len, offset);
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n <= 0)
+			return false;
+		p += n;
+		len -= n;
+		if (offset >= 0)
+			offset += n;
+	}
+
+	return true;
+}
+
+/**
+ * num_pages - pages covering size bytes
+ */
+static uint64_t num_pages(uint64_t size)
+{
+	return (size + MEMDUMP_PAGE_SIZE - 1) / MEMDUMP_PAGE_SIZE;
+}
+
+/**
+ * manifest_alloc - allocate the hash array and bitmap of a manifest
+ */
+static bool manifest_alloc(memdump_manifest_t *m, uint64_t pages)
+{
+	if (pages > SIZE_MAX / sizeof(uint64_t))
+		return false;
+
+	m->hashes = calloc(pages ? pages : 1, sizeof(uint64_t));
+	m->changed = calloc((pages + 7) / 8 + 1, 1);
+	if (m->hashes == NULL || m->changed == NULL) {
+		memdump_manifest_free(m);
+		return false;
+	}
+
+	return true;
+}
+
+/**
+ * memdump_manifest_load - read a manifest written by memdump_manifest_save()
+ */
+bool memdump_manifest_load(memdump_manifest_t *m, const char *path)
+{
+	memdump_manifest_header_t *hdr = &m->hdr;
+	bool ok = false;
+	int fd;
+
+	memset(m, 0, sizeof(*m));
+
+	fd = open(path, O_RDONLY);
+	if (fd < 0) {
+		printf("Unable to open manifest %s: %s\n", path, strerror(errno));
+		return false;
+	}
+
+	if (!io_all(fd, hdr, sizeof(*hdr), 0, false) || hdr->magic != MEMDUMP_MANIFEST_MAGIC ||
+	    hdr->version != MEMDUMP_MANIFEST_VERSION || hdr->page_size != MEMDUMP_PAGE_SIZE ||
+	    hdr->num_pages != num_pages(hdr->size)) {
+		printf("%s is not a memdump manifest\n", path);
+		goto end;
+	}
+
+	if (!manifest_alloc(m, hdr->num_pages))
+		goto end;
+
+	ok = io_all(fd, m->hashes, hdr->num_pages * sizeof(uint64_t), sizeof(*hdr), false) &&
+	     io_all(fd, m->changed, (hdr->num_pages + 7) / 8, sizeof(*hdr) + hdr->num_pages * sizeof(uint64_t),
+		    false);
+	if (!ok) {
+		printf("Manifest %s is truncated\n", path);
+		memdump_manifest_free(m);
+	}
+
+end:
+	close(fd);
+
+	return ok;
+}
+
+/**
+ * memdump_manifest_save - write a manifest
+ */
+bool memdump_manifest_save(const memdump_manifest_t *m, const char *path)
+{
+	bool ok;
+	int fd;
+
+	fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0640);
+	if (fd < 0) {
+		printf("Unable to open manifest %s: %s\n", path, strerror(errno));
+		return false;
+	}
+
+	ok = io_all(fd, (void *)&m->hdr, sizeof(m->hdr), -1, true) &&
+	     io_all(fd, m->hashes, m->hdr.num_pages * sizeof(uint64_t), -1, true) &&
+	     io_all(fd, m->changed, (m->hdr.num_pages + 7) / 8, -1, true);
+	if (close(fd) != 0)
+		ok = false;
+	if (!ok)
+		printf("Unable to write manifest %s\n", path);
+
+	return ok;
+}
+
+/**
+ * memdump_manifest_free - release the arrays of a manifest
+ */
+void memdump_manifest_free(memdump_manifest_t *m)
+{
+	free(m->hashes);
+	free(m->changed);
+	m->hashes = NULL;
+	m->changed = NULL;
+}
+
+/**
+ * memdump_delta_init - start an incremental dump of a record of size bytes
+ *
+ * Changed pages are written to fd. A base of another record is ignored, and
+ * every page written.
+ */
+bool memdump_delta_init(memdump_delta_t *delta, const memdump_manifest_t *base, uint32_t record, uint64_t size,
+			int fd)
+{
+	memdump_manifest_header_t *hdr = &delta->manifest.hdr;
+
+	memset(delta, 0, sizeof(*delta));
+	delta->fd = fd;
+
+	if (base != NULL && base->hdr.record != record)
+		printf("Base manifest is of record %u, dumping every page\n", base->hdr.record);
+	else
+		delta->base = base;
+
+	hdr->magic = MEMDUMP_MANIFEST_MAGIC;
+	hdr->version = MEMDUMP_MANIFEST_VERSION;
+	hdr->record = record;
+	hdr->page_size = MEMDUMP_PAGE_SIZE;
+	hdr->size = size;
+	hdr->num_pages = num_pages(size);
+
+	return manifest_alloc(&delta->manifest, hdr->num_pages);
+}
+
+/**
+ * memdump_delta_update - hash the next len bytes of the record at byte pos
+ *
+ * pos must be page aligned; only the last update may end mid-page.
+ */
+bool memdump_delta_update(memdump_delta_t *delta, const uint8_t *data, size_t len, uint64_t pos)
+{
+	memdump_manifest_t *m = &delta->manifest;
+	const memdump_manifest_t *base = delta->base;
+	uint64_t page;
+	size_t off, n;
+	uint64_t h;
+
+	if (pos % MEMDUMP_PAGE_SIZE)
+		return false;
+
+	for (off = 0; off < len; off += n) {
+		n = (len - off < MEMDUMP_PAGE_SIZE) ? len - off : MEMDUMP_PAGE_SIZE;
+		page = (pos + off) / MEMDUMP_PAGE_SIZE;
+		if (page >= m->hdr.num_pages)
+			return false;
+
+		h = memdump_page_hash(data + off, n);
+		m->hashes[page] = h;
+		if (base != NULL && page < base->hdr.num_pages && base->hashes[page] == h)
+			continue;
+
+		if (!io_all(delta->fd, (void *)(data + off), n, -1, true)) {
+			printf("Unable to write delta: %s\n", strerror(errno));
+			return false;
+		}
+		m->changed[page / 8] |= 1 << (page % 8);
+		m->hdr.changed_pages++;
+	}
+
+	return true;
+}
+
+/**
+ * memdump_delta_finish - fill in what the dump returned and save the manifest
+ *
+ * size may be below the size given to memdump_delta_init() if the record came
+ * back short.
+ */
+bool memdump_delta_finish(memdump_delta_t *delta, uint64_t address, uint64_t size, const char *manifest_path)
+{
+	memdump_manifest_header_t *hdr = &delta->manifest.hdr;
+
+	if (size > hdr->size)
+		return false;
+	hdr->address = address;
+	hdr->size = size;
+	hdr->num_pages = num_pages(size);
+
+	return memdump_manifest_save(&delta->manifest, manifest_path);
+}
+
+/**
+ * memdump_delta_free - release an incremental dump
+ */
+void memdump_delta_free(memdump_delta_t *delta)
+{
+	memdump_manifest_free(&delta->manifest);
+}
+
+/**
+ * memdump_reconstruct - rebuild the full image of an incremental dump
+ *
+ * Unchanged pages come from the full image of the dump the delta was taken
+ * against, base_path; it may be NULL if every page changed.
+ */
+bool memdump_reconstruct(const char *base_path, const char *delta_path, const char *manifest_path,
+			 const char *out_path)
+{
+	memdump_manifest_t m;
+	uint8_t page[MEMDUMP_PAGE_SIZE];
+	int base_fd = -1, delta_fd = -1, out_fd = -1;
+	bool ok = false;
+	size_t n;
+
+	if (!memdump_manifest_load(&m, manifest_path))
+		return false;
+
+	if (m.hdr.changed_pages != m.hdr.num_pages && base_path == NULL) {
+		printf("Only 0x%llx of 0x%llx pages changed, the base image is needed\n",
+		       (unsigned long long)m.hdr.changed_pages, (unsigned long long)m.hdr.num_pages);
+		goto end;
+	}
+
+	delta_fd = open(delta_path, O_RDONLY);
+	if (base_path != NULL)
+		base_fd = open(base_path, O_RDONLY);
+	out_fd = open(out_path, O_WRONLY | O_CREAT | O_TRUNC, 0640);
+	if (delta_fd < 0 || (base_path != NULL && base_fd < 0) || out_fd < 0) {
+		printf("Unable to open files: %s\n", strerror(errno));
+		goto end;
+	}
+
+	for (uint64_t i = 0; i < m.hdr.num_pages; i++) {
+		n = (m.hdr.size - i * MEMDUMP_PAGE_SIZE < MEMDUMP_PAGE_SIZE) ? m.hdr.size - i * MEMDUMP_PAGE_SIZE :
+									       MEMDUMP_PAGE_SIZE;
+		if (m.changed[i / 8] & (1 << (i % 8))) {
+			if (!io_all(delta_fd, page, n, -1, false)) {
+				printf("Delta %s is truncated at page 0x%llx\n", delta_path, (unsigned long long)i);
+				goto end;
+			}
+		} else if (!io_all(base_fd, page, n, i * MEMDUMP_PAGE_SIZE, false)) {
+			printf("Base image %s is too short for page 0x%llx\n", base_path, (unsigned long long)i);
+			goto end;
+		}
+
+		/* Catches a base image that is not the one the delta was taken against */
+		if (memdump_page_hash(page, n) != m.hashes[i]) {
+			printf("Page 0x%llx does not match the manifest\n", (unsigned long long)i);
+			goto end;
+		}
+
+		if (!io_all(out_fd, page, n, -1, true)) {
+			printf("Unable to write %s\n", out_path);
+			goto end;
+		}
+	}
+	ok = true;
+
+end:
+	if (out_fd >= 0 && close(out_fd) != 0)
+		ok = false;
+	if (base_fd >= 0)
+		close(base_fd);
+	if (delta_fd >= 0)
+		close(delta_fd);
+	memdump_manifest_free(&m);
+
+	return ok;
+}
@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2026, Analog Devices Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef MEMDUMP_DELTA_H
+#define MEMDUMP_DELTA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Incremental dump of a record. The record is hashed per page and compared
+ * with the manifest of a previous dump of the same record; only the changed
+ * pages are written, in page order, to the delta file. The manifest of the
+ * new dump holds the hash of every page and a bitmap of the changed pages,
+ * and serves as the base of the next incremental dump:
+ *
+ *   memdump_manifest_header_t
+ *   uint64_t hashes[num_pages]
+ *   uint8_t  changed[(num_pages + 7) / 8]  bit n of byte n / 8 is page n
+ *
+ * The full image is rebuilt from the previous full image, the delta file and
+ * the manifest.
+ */
+#define MEMDUMP_MANIFEST_MAGIC 0x494d4441       /* "ADMI" */
+#define MEMDUMP_MANIFEST_VERSION 1
+#define MEMDUMP_MANIFEST_PATH "/tmp/memdump.idx"
+#define MEMDUMP_PAGE_SIZE 4096
+
+typedef struct memdump_manifest_header {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t record;
+	uint32_t page_size;
+	uint64_t address;       /* Address of the first byte of the record */
+	uint64_t size;          /* Bytes in the record */
+	uint64_t num_pages;
+	uint64_t changed_pages; /* Pages in the delta file */
+} memdump_manifest_header_t;
+
+typedef struct memdump_manifest {
+	memdump_manifest_header_t hdr;
+	uint64_t *hashes;
+	uint8_t *changed;
+} memdump_manifest_t;
+
+/* Incremental dump in progress */
+typedef struct memdump_delta {
+	const memdump_manifest_t *base; /* NULL to write every page */
+	memdump_manifest_t manifest;
+	int fd;                 /* Delta file */
+} memdump_delta_t;
+
+uint64_t memdump_page_hash(const uint8_t *data, size_t len);
+
+bool memdump_manifest_load(memdump_manifest_t *m, const char *path);
+bool memdump_manifest_save(const memdump_manifest_t *m, const char *path);
+void memdump_manifest_free(memdump_manifest_t *m);
+
+bool memdump_delta_init(memdump_delta_t *delta, const memdump_manifest_t *base, uint32_t record, uint64_t size,
+			int fd);
+bool memdump_delta_update(memdump_delta_t *delta, const uint8_t *data, size_t len, uint64_t pos);
+bool memdump_delta_finish(memdump_delta_t *delta, uint64_t address, uint64_t size, const char *manifest_path);
+void memdump_delta_free(memdump_delta_t *delta);
+
+bool memdump_reconstruct(const char *base_path, const char *delta_path, const char *manifest_path,
+			 const char *out_path);
+
+#endif /* MEMDUMP_DELTA_H */
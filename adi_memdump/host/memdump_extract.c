@@ -0,0 +1,347 @@
+/*
+ * Copyright (c) 2026, Analog Devices Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Reads memdump output back without talking to the TEE: lists the records of
+ * a container and extracts records, decompressing them if needed.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "memdump_compress.h"
+#include "memdump_container.h"
+#include "memdump_delta.h"
+
+/* Command help */
+#define HELP "\n\
+Usage:  %1$s file \n\
+        %1$s container record output \n\
+        %1$s file output \n\
+        %1$s -r base delta manifest output \n\
+  - file: container or single record from adi_memdump \n\
+  - with only a file, list the records of a container \n\
+  - record: record number to extract from a container to output \n\
+  - a single record is copied to output, decompressed if needed \n\
+  - -r: rebuild the full image of an incremental dump from the full image \n\
+    of the dump it was taken against (base, '-' if every page changed), \n\
+    its changed pages (delta) and its manifest \n\
+\n"
+
+/* A file mapped read-only */
+struct mapped {
+	const uint8_t *data;
+	size_t len;
+};
+
+/**
+ * map_file - map a whole file read-only
+ */
+static bool map_file(const char *path, struct mapped *m)
+{
+	struct stat st;
+	int fd;
+
+	fd = open(path, O_RDONLY);
+	if (fd < 0) {
+		printf("Unable to open %s: %s\n", path, strerror(errno));
+		return false;
+	}
+	if (fstat(fd, &st) != 0) {
+		close(fd);
+		return false;
+	}
+
+	m->len = st.st_size;
+	m->data = m->len ? mmap(NULL, m->len, PROT_READ, MAP_PRIVATE, fd, 0) : NULL;
+	close(fd);
+	if (m->data == MAP_FAILED) {
+		printf("Unable to map %s: %s\n", path, strerror(errno));
+		return false;
+	}
+
+	return true;
+}
+
+/**
+ * write_all - write a whole buffer to fd
+ */
+static bool write_all(int fd, const void *data, size_t len)
+{
+	const uint8_t *p = data;
+	ssize_t n;
+
+	while (len > 0) {
+		n = write(fd, p, len);
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n <= 0)
+			return false;
+		p += n;
+		len -= n;
+	}
+
+	return true;
+}
+
+/**
+ * is_stream - check whether data starts with a compressed stream header
+ */
+static bool is_stream(const uint8_t *data, size_t len)
+{
+	memdump_stream_header_t hdr;
+
+	if (len < sizeof(hdr))
+		return false;
+	memcpy(&hdr, data, sizeof(hdr));
+
+	return hdr.magic == MEMDUMP_STREAM_MAGIC;
+}
+
+/**
+ * decompress - write the record held by a compressed stream to fd
+ *
+ * Returns the number of record bytes written, or -1 on a corrupt stream.
+ */
+static int64_t decompress(const uint8_t *data, size_t len, int fd)
+{
+	static const uint8_t zeros[MEMDUMP_ZERO_PAGE_SIZE];
+	memdump_stream_header_t shdr;
+	memdump_block_header_t hdr;
+	uint8_t *buf = NULL;
+	size_t buf_size = 0;
+	size_t pos = sizeof(shdr);
+	int64_t total = 0;
+	size_t n;
+	uint8_t *p;
+
+	if (!is_stream(data, len)) {
+		printf("Not a compressed stream\n");
+		return -1;
+	}
+	memcpy(&shdr, data, sizeof(shdr));
+	if (shdr.version != MEMDUMP_STREAM_VERSION) {
+		printf("Unsupported stream version %u\n", shdr.version);
+		return -1;
+	}
+
+	for (;;) {
+		if (len - pos < sizeof(hdr))
+			goto corrupt;
+		memcpy(&hdr, data + pos, sizeof(hdr));
+		pos += sizeof(hdr);
+		if (hdr.stored_size > len - pos)
+			goto corrupt;
+
+		switch (hdr.type) {
+		case MEMDUMP_BLOCK_END:
+			free(buf);
+			return total;
+		case MEMDUMP_BLOCK_RAW:
+			if (hdr.stored_size != hdr.raw_size || !write_all(fd, data + pos, hdr.raw_size))
+				goto corrupt;
+			break;
+		case MEMDUMP_BLOCK_ZERO:
+			for (size_t left = hdr.raw_size; left > 0; left -= n) {
+				n = (left < sizeof(zeros)) ? left : sizeof(zeros);
+				if (!write_all(fd, zeros, n))
+					goto corrupt;
+			}
+			break;
+		case MEMDUMP_BLOCK_LZ4:
+			if (hdr.raw_size > buf_size) {
+				p = realloc(buf, hdr.raw_size);
+				if (p == NULL)
+					goto corrupt;
+				buf = p;
+				buf_size = hdr.raw_size;
+			}
+			if (!memdump_decompress_lz4(data + pos, hdr.stored_size, buf, hdr.raw_size) ||
+			    !write_all(fd, buf, hdr.raw_size))
+				goto corrupt;
+			break;
+		default:
+			goto corrupt;
+		}
+
+		pos += hdr.stored_size;
+		total += hdr.raw_size;
+	}
+
+corrupt:
+	printf("Corrupt or truncated stream at offset 0x%zx\n", pos);
+	free(buf);
+	return -1;
+}
+
+/**
+ * extract - write a raw or compressed record to path
+ *
+ * size is the expected record size, 0 when unknown.
+ */
+static bool extract(const uint8_t *data, size_t len, bool compressed, uint64_t size, const char *path)
+{
+	int64_t n;
+	bool ok;
+	int fd;
+
+	fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0640);
+	if (fd < 0) {
+		printf("Unable to open %s: %s\n", path, strerror(errno));
+		return false;
+	}
+
+	if (compressed) {
+		n = decompress(data, len, fd);
+		ok = n >= 0;
+		if (ok && size != 0 && (uint64_t)n != size)
+			printf("Warning: record is 0x%llx bytes, expected 0x%llx\n", (unsigned long long)n,
+			       (unsigned long long)size);
+	} else {
+		ok = write_all(fd, data, len);
+		if (!ok)
+			printf("Unable to write %s\n", path);
+	}
+
+	if (close(fd) != 0)
+		ok = false;
+
+	return ok;
+}
+
+/**
+ * is_container - check whether data starts with a container header
+ */
+static bool is_container(const uint8_t *data, size_t len)
+{
+	uint32_t magic;
+
+	if (len < sizeof(magic))
+		return false;
+	memcpy(&magic, data, sizeof(magic));
+
+	return magic == MEMDUMP_CONTAINER_MAGIC;
+}
+
+/**
+ * container_header - validate the container header and record table
+ */
+static const memdump_container_header_t *container_header(const struct mapped *m)
+{
+	const memdump_container_header_t *hdr = (const void *)m->data;
+	const memdump_container_entry_t *entries;
+
+	if (m->len < sizeof(*hdr) || hdr->version != MEMDUMP_CONTAINER_VERSION || hdr->entry_size != sizeof(memdump_container_entry_t) ||
+	    (m->len - sizeof(*hdr)) / sizeof(memdump_container_entry_t) < hdr->num_records) {
+		printf("Unsupported or truncated container\n");
+		return NULL;
+	}
+
+	entries = (const void *)(hdr + 1);
+	for (uint32_t i = 0; i < hdr->num_records; i++) {
+		if (entries[i].offset > m->len || entries[i].stored_size > m->len - entries[i].offset) {
+			printf("Record %u lies outside the container\n", i);
+			return NULL;
+		}
+	}
+
+	return hdr;
+}
+
+/* MAIN */
+int main(int argc, char *argv[])
+{
+	const memdump_container_header_t *hdr;
+	const memdump_container_entry_t *entries;
+	const memdump_container_entry_t *e;
+	struct mapped m;
+	char *end;
+	unsigned long record;
+	bool ok = true;
+
+	if (argc == 6 && strcmp(argv[1], "-r") == 0)
+		return memdump_reconstruct(strcmp(argv[2], "-") ? argv[2] : NULL, argv[3], argv[4], argv[5]) ? 0 : 1;
+
+	if (argc < 2 || argc > 4) {
+		printf(HELP, argv[0]);
+		return 1;
+	}
+
+	if (!map_file(argv[1], &m))
+		return 1;
+
+	hdr = NULL;
+	entries = NULL;
+	if (is_container(m.data, m.len)) {
+		hdr = container_header(&m);
+		if (hdr == NULL)
+			return 1;
+		entries = (const void *)(hdr + 1);
+	}
+
+	if (argc == 2) {
+		if (hdr == NULL) {
+			printf("%s is not a container\n", argv[1]);
+			return 1;
+		}
+		printf("record  address             size        stored      width endian\n");
+		for (uint32_t i = 0; i < hdr->num_records; i++) {
+			e = &entries[i];
+			printf("%6u  0x%016llx  0x%08llx  0x%08llx  %5u %6u%s\n", e->record,
+			       (unsigned long long)e->address, (unsigned long long)e->size,
+			       (unsigned long long)e->stored_size, e->width, e->endianness,
+			       (e->flags & MEMDUMP_ENTRY_COMPRESSED) ? "  compressed" : "");
+		}
+	} else if (argc == 4) {
+		if (hdr == NULL) {
+			printf("%s is not a container\n", argv[1]);
+			return 1;
+		}
+		record = strtoul(argv[2], &end, 0);
+		if (*end != '\0' || record >= hdr->num_records) {
+			printf("Invalid record number '%s'.\n", argv[2]);
+			return 1;
+		}
+		e = &entries[record];
+		ok = extract(m.data + e->offset, e->stored_size, e->flags & MEMDUMP_ENTRY_COMPRESSED, e->size,
+			     argv[3]);
+	} else {
+		if (hdr != NULL) {
+			printf("%s is a container, give a record number\n", argv[1]);
+			return 1;
+		}
+		ok = extract(m.data, m.len, is_stream(m.data, m.len), 0, argv[2]);
+	}
+
+	return ok ? 0 : 1;
+}
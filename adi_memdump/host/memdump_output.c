@@ -0,0 +1,184 @@
+/*
+ * Copyright (c) 2026, Analog Devices Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/* O_DIRECT */
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "adi_memdump.h"
+
+/* Destination of a record streamed to a file descriptor */
+struct fd_sink_arg {
+	int fd;
+	uint64_t offset;        /* File offset of byte 0 of the record */
+};
+
+/**
+ * fd_sink - memdump_sink_t writing a record at its offset in a file
+ *
+ * With O_DIRECT every chunk but the last is a whole number of blocks at a
+ * block aligned position; O_DIRECT is dropped for an unaligned tail.
+ */
+static bool fd_sink(void *arg, uint8_t *data, size_t len, uint64_t pos)
+{
+	struct fd_sink_arg *dst = arg;
+	uint64_t offset = dst->offset + pos;
+	int flags;
+	ssize_t n;
+
+	if ((len | offset) & (MEMDUMP_DIRECT_ALIGN - 1)) {
+		flags = fcntl(dst->fd, F_GETFL);
+		if (flags >= 0 && (flags & O_DIRECT))
+			fcntl(dst->fd, F_SETFL, flags & ~O_DIRECT);
+	}
+
+	while (len > 0) {
+		n = pwrite(dst->fd, data, len, offset);
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n <= 0) {
+			printf("Unable to write memdump output: %s\n", strerror(n < 0 ? errno : EIO));
+			return false;
+		}
+		data += n;
+		len -= n;
+		offset += n;
+	}
+
+	return true;
+}
+
+/**
+ * adi_memdump_mmap - Dump part of a record straight into a mapped output file
+ *
+ * Bytes [start, start + length) of the record go to the file at
+ * offset + start, where offset is the file offset of byte 0 of the record.
+ * The file must already extend to offset + start + length. The file is mapped and
+ * registered as shared memory MEMDUMP_MAP_CHUNK_SIZE bytes at a time, so the
+ * TA writes into the page cache and the data is never copied on the host.
+ * Fails without touching the file if the pages cannot be registered, e.g.
+ * when the kernel does not allow pinning pages of that file system.
+ */
+TEEC_Result adi_memdump_mmap(memdump_session_t *session, uint32_t record, uint64_t start, uint64_t length, int fd,
+			     uint64_t offset, enum memdump_endian convert, memdump_record_info_t *info)
+{
+	TEEC_Result res = TEEC_SUCCESS;
+	TEEC_SharedMemory shm;
+	memdump_record_info_t chunk_info;
+	uint64_t page_mask = sysconf(_SC_PAGESIZE) - 1;
+	uint64_t end = start + length;
+	uint64_t pos = start;
+	unsigned int swap_width = 0;
+	uint64_t base;
+	size_t delta;
+	uint32_t len;
+	void *map;
+
+	memset(info, 0, sizeof(*info));
+	info->record = record;
+
+	do {
+		len = (end - pos < MEMDUMP_MAP_CHUNK_SIZE) ? end - pos : MEMDUMP_MAP_CHUNK_SIZE;
+
+		/* mmap needs a page aligned file offset */
+		base = (offset + pos) & ~page_mask;
+		delta = offset + pos - base;
+		map = mmap(NULL, delta + (len ? len : 1), PROT_READ | PROT_WRITE, MAP_SHARED, fd, base);
+		if (map == MAP_FAILED) {
+			printf("Unable to map memdump output: %s\n", strerror(errno));
+			return TEEC_ERROR_GENERIC;
+		}
+
+		memset(&shm, 0, sizeof(shm));
+		shm.buffer = map;
+		shm.size = delta + (len ? len : 1);
+		shm.flags = TEEC_MEM_OUTPUT;
+		res = TEEC_RegisterSharedMemory(&session->ctx, &shm);
+		if (res != TEEC_SUCCESS) {
+			munmap(map, delta + (len ? len : 1));
+			return res;
+		}
+
+		res = adi_memdump_fetch_chunk(session, &shm, delta, record, pos, &len, &chunk_info);
+		if (res == TEEC_SUCCESS && pos == start) {
+			info->address = chunk_info.address;
+			info->width = chunk_info.width;
+			info->endianness = chunk_info.endianness;
+			if (!memdump_convert_width(convert, info->width, start, &info->endianness, &swap_width))
+				res = TEEC_ERROR_BAD_FORMAT;
+		}
+		if (res == TEEC_SUCCESS && swap_width)
+			memdump_bswap((uint8_t *)map + delta, len, swap_width);
+
+		TEEC_ReleaseSharedMemory(&shm);
+		munmap(map, shm.size);
+
+		if (res != TEEC_SUCCESS)
+			return res;
+		if (len == 0)
+			break;
+		pos += len;
+	} while (pos < end);
+
+	info->size = pos - start;
+
+	return TEEC_SUCCESS;
+}
+
+/**
+ * adi_memdump_to_fd - Dump part of a record to a file holding the record at offset
+ *
+ * Bytes [start, start + length) of the record are written at offset + start.
+ * For MEMDUMP_OUTPUT_MMAP the file must extend to offset + start + length; the dump
+ * falls back to streaming if the TA cannot write into the mapped file. For
+ * MEMDUMP_OUTPUT_DIRECT the caller opens fd with O_DIRECT and offset must be
+ * MEMDUMP_DIRECT_ALIGN aligned.
+ */
+TEEC_Result adi_memdump_to_fd(memdump_session_t *session, uint32_t record, uint64_t start, uint64_t length, int fd,
+			      uint64_t offset, enum memdump_output output, enum memdump_endian convert,
+			      memdump_record_info_t *info)
+{
+	TEEC_Result res;
+	struct fd_sink_arg dst = {
+		.fd = fd,
+		.offset = offset,
+	};
+
+	if (output == MEMDUMP_OUTPUT_MMAP) {
+		res = adi_memdump_mmap(session, record, start, length, fd, offset, convert, info);
+		if (!adi_memdump_unknown_cmd(res) && res != TEEC_ERROR_OUT_OF_MEMORY)
+			return res;
+	}
+
+	return adi_memdump_stream_range(session, record, start, length, convert, fd_sink, &dst, info);
+}
@@ -0,0 +1,245 @@
+/*
+ * Copyright (c) 2026, Analog Devices Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "adi_memdump.h"
+#include "memdump_container.h"
+
+/*
+ * Records are cut into segments of up to MEMDUMP_SEGMENT_SIZE bytes. Workers
+ * take the next segment in record order, each over its own session and with
+ * its own shared buffers, and write it at its fixed place in the container,
+ * so neither the order of completion nor the number of workers changes the
+ * output.
+ */
+#define MEMDUMP_SEGMENT_SIZE (16 * 1024 * 1024)
+
+struct segment {
+	uint32_t record;
+	uint64_t start;
+	uint64_t length;
+};
+
+struct parallel {
+	pthread_mutex_t lock;
+	struct segment *segments;
+	size_t num_segments;
+	size_t next;                    /* Next segment to take */
+	TEEC_Result res;                /* First failure */
+	memdump_container_t *container;
+	enum memdump_output output;
+	enum memdump_endian convert;
+	memdump_record_info_t *infos;   /* Per record */
+};
+
+struct worker {
+	pthread_t thread;
+	memdump_session_t *session;
+	memdump_session_t own;          /* Session of all but the first worker */
+	struct parallel *parallel;
+};
+
+/* Destination of a segment in the container */
+struct segment_sink_arg {
+	memdump_container_t *container;
+	uint32_t index;
+};
+
+/**
+ * segment_sink - memdump_sink_t writing a segment at its offset in the container
+ */
+static bool segment_sink(void *arg, uint8_t *data, size_t len, uint64_t pos)
+{
+	struct segment_sink_arg *dst = arg;
+
+	return memdump_container_write(dst->container, dst->index, data, len, pos);
+}
+
+/**
+ * dump_segment - dump one segment over the worker's session
+ */
+static TEEC_Result dump_segment(struct worker *w, const struct segment *seg, memdump_record_info_t *info)
+{
+	struct parallel *p = w->parallel;
+	struct segment_sink_arg dst = {
+		.container = p->container,
+		.index = seg->record,
+	};
+
+	if (p->output == MEMDUMP_OUTPUT_STDIO)
+		return adi_memdump_stream_range(w->session, seg->record, seg->start, seg->length, p->convert,
+						segment_sink, &dst, info);
+
+	return adi_memdump_to_fd(w->session, seg->record, seg->start, seg->length, p->container->fd,
+				 p->container->entries[seg->record].offset, p->output, p->convert, info);
+}
+
+/**
+ * worker_main - take segments until none are left or a worker failed
+ */
+static void *worker_main(void *arg)
+{
+	struct worker *w = arg;
+	struct parallel *p = w->parallel;
+	memdump_record_info_t info;
+	memdump_record_info_t *rec;
+	const struct segment *seg;
+	TEEC_Result res;
+
+	for (;;) {
+		pthread_mutex_lock(&p->lock);
+		if (p->res != TEEC_SUCCESS || p->next == p->num_segments) {
+			pthread_mutex_unlock(&p->lock);
+			break;
+		}
+		seg = &p->segments[p->next++];
+		pthread_mutex_unlock(&p->lock);
+
+		res = dump_segment(w, seg, &info);
+
+		pthread_mutex_lock(&p->lock);
+		if (res != TEEC_SUCCESS) {
+			if (p->res == TEEC_SUCCESS)
+				p->res = res;
+			printf("Unable to dump record %u at 0x%llx\n", seg->record, (unsigned long long)seg->start);
+		} else {
+			rec = &p->infos[seg->record];
+			if (seg->start == 0) {
+				rec->address = info.address;
+				rec->width = info.width;
+				rec->endianness = info.endianness;
+			}
+			rec->size += info.size;
+		}
+		pthread_mutex_unlock(&p->lock);
+	}
+
+	return NULL;
+}
+
+/**
+ * adi_memdump_parallel - Dump every record of a laid out container with up to opts->jobs workers
+ *
+ * session serves the first worker; the others open their own. The number of
+ * workers is capped to the number of segments and to the number of CPUs,
+ * which is what OP-TEE normally sizes its thread pool to (CFG_NUM_THREADS).
+ * A session that cannot be opened, for instance because the TEE is out of
+ * threads, leaves the dump to the workers that have one. infos[] receives
+ * the description of each record.
+ */
+TEEC_Result adi_memdump_parallel(memdump_session_t *session, memdump_container_t *container,
+				 const memdump_options_t *opts, memdump_record_info_t *infos)
+{
+	struct parallel p;
+	struct worker *workers;
+	long cpus = sysconf(_SC_NPROCESSORS_CONF);
+	unsigned int jobs = opts->jobs;
+	unsigned int started = 0;
+	uint64_t size;
+	size_t n = 0;
+
+	memset(&p, 0, sizeof(p));
+	p.container = container;
+	p.output = opts->output;
+	p.convert = opts->convert;
+	p.infos = infos;
+
+	/* Zero sized records still get one segment, to learn their address */
+	for (uint32_t i = 0; i < container->num_records; i++)
+		n += container->entries[i].size ? (container->entries[i].size + MEMDUMP_SEGMENT_SIZE - 1) /
+							  MEMDUMP_SEGMENT_SIZE : 1;
+	p.segments = calloc(n ? n : 1, sizeof(*p.segments));
+	if (p.segments == NULL)
+		return TEEC_ERROR_OUT_OF_MEMORY;
+	for (uint32_t i = 0; i < container->num_records; i++) {
+		memset(&infos[i], 0, sizeof(infos[i]));
+		infos[i].record = i;
+		size = container->entries[i].size;
+		for (uint64_t start = 0;; start += MEMDUMP_SEGMENT_SIZE) {
+			p.segments[p.num_segments].record = i;
+			p.segments[p.num_segments].start = start;
+			p.segments[p.num_segments].length = (size - start < MEMDUMP_SEGMENT_SIZE) ? size - start :
+												   MEMDUMP_SEGMENT_SIZE;
+			p.num_segments++;
+			if (size - start <= MEMDUMP_SEGMENT_SIZE)
+				break;
+		}
+	}
+
+	if (jobs > p.num_segments)
+		jobs = p.num_segments;
+	if (cpus > 0 && jobs > cpus)
+		jobs = cpus;
+	if (jobs == 0)
+		jobs = 1;
+
+	workers = calloc(jobs, sizeof(*workers));
+	if (workers == NULL) {
+		free(p.segments);
+		return TEEC_ERROR_OUT_OF_MEMORY;
+	}
+	pthread_mutex_init(&p.lock, NULL);
+
+	for (unsigned int i = 0; i < jobs; i++) {
+		workers[i].parallel = &p;
+		workers[i].session = session;
+		if (i > 0) {
+			if (adi_memdump_open_session(&workers[i].own) != TEEC_SUCCESS) {
+				printf("Continuing with %u workers\n", i);
+				break;
+			}
+			workers[i].session = &workers[i].own;
+		}
+		if (pthread_create(&workers[i].thread, NULL, worker_main, &workers[i]) != 0) {
+			if (i > 0)
+				adi_memdump_close_session(&workers[i].own);
+			break;
+		}
+		started++;
+	}
+
+	/* Without any thread, dump everything on this one */
+	if (started == 0)
+		worker_main(&workers[0]);
+
+	for (unsigned int i = 0; i < started; i++) {
+		pthread_join(workers[i].thread, NULL);
+		if (i > 0)
+			adi_memdump_close_session(&workers[i].own);
+	}
+
+	pthread_mutex_destroy(&p.lock);
+	free(workers);
+	free(p.segments);
+
+	return p.res;
+}
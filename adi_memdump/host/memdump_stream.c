@@ -0,0 +1,334 @@
+/*
+ * Copyright (c) 2026, Analog Devices Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "adi_memdump.h"
+
+/*
+ * A record is streamed through two halves of one registered shared buffer.
+ * The calling thread fetches chunk N+1 into one half while a writer thread
+ * hands chunk N in the other half to the sink.
+ */
+struct memdump_stream {
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	uint8_t *slot[2];
+	uint32_t len[2];
+	uint64_t pos[2];
+	bool full[2];
+	bool done;      /* No more chunks will be fetched */
+	bool failed;    /* The sink failed */
+	unsigned int swap_width;        /* Byte swap chunks by words of this size, 0 for none */
+	memdump_sink_t sink;
+	void *arg;
+};
+
+/**
+ * stream_writer - writer thread, drains the slots in order until done
+ */
+static void *stream_writer(void *data)
+{
+	struct memdump_stream *stream = data;
+	int i = 0;
+	bool ok;
+
+	pthread_mutex_lock(&stream->lock);
+	for (;;) {
+		while (!stream->full[i] && !stream->done)
+			pthread_cond_wait(&stream->cond, &stream->lock);
+		if (!stream->full[i])
+			break;
+		pthread_mutex_unlock(&stream->lock);
+
+		/* Converted here, overlapped with fetching the next chunk */
+		if (stream->swap_width)
+			memdump_bswap(stream->slot[i], stream->len[i], stream->swap_width);
+		ok = stream->sink(stream->arg, stream->slot[i], stream->len[i], stream->pos[i]);
+
+		pthread_mutex_lock(&stream->lock);
+		stream->full[i] = false;
+		if (!ok) {
+			stream->failed = true;
+			pthread_cond_broadcast(&stream->cond);
+			break;
+		}
+		pthread_cond_broadcast(&stream->cond);
+		i ^= 1;
+	}
+	pthread_mutex_unlock(&stream->lock);
+
+	return NULL;
+}
+
+/**
+ * stream_whole - fallback for a TA without chunk support, dump the record in one go
+ *
+ * The TA can only return the whole record, so a range is cut out of it here.
+ */
+static TEEC_Result stream_whole(memdump_session_t *session, uint32_t record, uint64_t start, uint64_t length,
+				enum memdump_endian convert, memdump_sink_t sink, void *arg, memdump_record_info_t *info)
+{
+	TEEC_Result res;
+	unsigned int swap_width;
+	uint32_t size;
+	uint8_t *data;
+
+	res = adi_memdump_record_size(session, record, &size);
+	if (res != TEEC_SUCCESS)
+		return res;
+
+	data = malloc(size ? size : 1);
+	if (data == NULL)
+		return TEEC_ERROR_OUT_OF_MEMORY;
+
+	res = adi_memdump_fetch(session, record, data, size, info);
+	if (res == TEEC_SUCCESS) {
+		if (start > info->size)
+			start = info->size;
+		if (length > info->size - start)
+			length = info->size - start;
+		info->size = length;
+
+		if (!memdump_convert_width(convert, info->width, start, &info->endianness, &swap_width))
+			res = TEEC_ERROR_BAD_FORMAT;
+		else if (swap_width)
+			memdump_bswap(data + start, length, swap_width);
+		if (res == TEEC_SUCCESS && !sink(arg, data + start, length, start))
+			res = TEEC_ERROR_GENERIC;
+	}
+
+	free(data);
+
+	return res;
+}
+
+/**
+ * adi_memdump_stream_range - Dump length bytes of a record from byte start to a sink
+ *
+ * Only 2 * MEMDUMP_CHUNK_SIZE bytes of the record are resident at a time,
+ * whatever the record size. The sink sees the range in order, with positions
+ * relative to the start of the record, and the shared buffer is registered
+ * once for the whole range. info->size is the number of bytes dumped, which
+ * is short only at the end of the record. Multi-byte words are converted to
+ * the endianness asked for by convert on the writer thread, and
+ * info->endianness is that of the data the sink gets.
+ */
+TEEC_Result adi_memdump_stream_range(memdump_session_t *session, uint32_t record, uint64_t start, uint64_t length,
+				     enum memdump_endian convert, memdump_sink_t sink, void *arg,
+				     memdump_record_info_t *info)
+{
+	TEEC_Result res = TEEC_SUCCESS;
+	TEEC_SharedMemory shm;
+	struct memdump_stream stream;
+	memdump_record_info_t chunk_info;
+	pthread_t writer;
+	uint64_t end = start + length;
+	uint64_t offset = start;
+	uint32_t len;
+	int i = 0;
+
+	memset(&stream, 0, sizeof(stream));
+	memset(&shm, 0, sizeof(shm));
+	memset(info, 0, sizeof(*info));
+	info->record = record;
+
+	/* Aligned so that the sink may write the window with O_DIRECT */
+	if (posix_memalign(&shm.buffer, MEMDUMP_DIRECT_ALIGN, 2 * MEMDUMP_CHUNK_SIZE) != 0)
+		return TEEC_ERROR_OUT_OF_MEMORY;
+	shm.size = 2 * MEMDUMP_CHUNK_SIZE;
+	shm.flags = TEEC_MEM_OUTPUT;
+
+	res = TEEC_RegisterSharedMemory(&session->ctx, &shm);
+	if (res != TEEC_SUCCESS) {
+		printf("TEEC_RegisterSharedMemory failed with code 0x%x\n", res);
+		free(shm.buffer);
+		return res;
+	}
+
+	pthread_mutex_init(&stream.lock, NULL);
+	pthread_cond_init(&stream.cond, NULL);
+	stream.slot[0] = shm.buffer;
+	stream.slot[1] = (uint8_t *)shm.buffer + MEMDUMP_CHUNK_SIZE;
+	stream.sink = sink;
+	stream.arg = arg;
+
+	if (pthread_create(&writer, NULL, stream_writer, &stream) != 0) {
+		printf("Unable to start memdump writer thread\n");
+		res = TEEC_ERROR_GENERIC;
+		goto release;
+	}
+
+	/* Zero sized records still report their address with one empty fetch */
+	do {
+		pthread_mutex_lock(&stream.lock);
+		while (stream.full[i] && !stream.failed)
+			pthread_cond_wait(&stream.cond, &stream.lock);
+		pthread_mutex_unlock(&stream.lock);
+		if (stream.failed) {
+			res = TEEC_ERROR_GENERIC;
+			break;
+		}
+
+		len = (end - offset < MEMDUMP_CHUNK_SIZE) ? end - offset : MEMDUMP_CHUNK_SIZE;
+		res = adi_memdump_fetch_chunk(session, &shm, stream.slot[i] - (uint8_t *)shm.buffer, record, offset,
+					      &len, &chunk_info);
+		if (res != TEEC_SUCCESS)
+			break;
+		if (offset == start) {
+			info->address = chunk_info.address;
+			info->width = chunk_info.width;
+			info->endianness = chunk_info.endianness;
+			/* Published to the writer with the first chunk */
+			if (!memdump_convert_width(convert, info->width, start, &info->endianness, &stream.swap_width)) {
+				res = TEEC_ERROR_BAD_FORMAT;
+				break;
+			}
+		}
+		if (len == 0)
+			break;
+
+		pthread_mutex_lock(&stream.lock);
+		stream.len[i] = len;
+		stream.pos[i] = offset;
+		stream.full[i] = true;
+		pthread_cond_broadcast(&stream.cond);
+		pthread_mutex_unlock(&stream.lock);
+
+		offset += len;
+		i ^= 1;
+	} while (offset < end);
+
+	pthread_mutex_lock(&stream.lock);
+	stream.done = true;
+	pthread_cond_broadcast(&stream.cond);
+	pthread_mutex_unlock(&stream.lock);
+	pthread_join(writer, NULL);
+
+	if (res == TEEC_SUCCESS && stream.failed)
+		res = TEEC_ERROR_GENERIC;
+	info->size = offset - start;
+
+release:
+	pthread_cond_destroy(&stream.cond);
+	pthread_mutex_destroy(&stream.lock);
+	TEEC_ReleaseSharedMemory(&shm);
+	free(shm.buffer);
+
+	/* A TA without the chunk command can only dump whole records */
+	if (adi_memdump_unknown_cmd(res) && offset == start)
+		res = stream_whole(session, record, start, length, convert, sink, arg, info);
+
+	return res;
+}
+
+/**
+ * adi_memdump_stream - Dump a record of the given size to a sink
+ */
+TEEC_Result adi_memdump_stream(memdump_session_t *session, uint32_t record, uint64_t size,
+			       enum memdump_endian convert, memdump_sink_t sink, void *arg, memdump_record_info_t *info)
+{
+	return adi_memdump_stream_range(session, record, 0, size, convert, sink, arg, info);
+}
+
+/* Compressor stage in front of another sink */
+struct compress_sink_arg {
+	memdump_compressor_t compressor;
+	memdump_sink_t sink;
+	void *arg;
+	uint64_t pos;           /* Bytes passed on to the sink */
+};
+
+/**
+ * compress_out - pass n bytes of compressor output on to the next sink
+ */
+static bool compress_out(struct compress_sink_arg *stage, size_t n)
+{
+	if (!stage->sink(stage->arg, stage->compressor.out, n, stage->pos))
+		return false;
+	stage->pos += n;
+
+	return true;
+}
+
+/**
+ * compress_sink - memdump_sink_t compressing each chunk on the writer thread
+ */
+static bool compress_sink(void *arg, uint8_t *data, size_t len, uint64_t pos)
+{
+	struct compress_sink_arg *stage = arg;
+	size_t n;
+
+	/* Only the whole record fallback passes more than a chunk */
+	while (len > 0) {
+		n = (len < MEMDUMP_CHUNK_SIZE) ? len : MEMDUMP_CHUNK_SIZE;
+		if (!compress_out(stage, memdump_compress(&stage->compressor, data, n)))
+			return false;
+		data += n;
+		len -= n;
+	}
+
+	return true;
+}
+
+/**
+ * adi_memdump_stream_compressed - Dump length bytes of a record from byte start through a compressor
+ *
+ * The sink gets a memdump_compress.h stream instead of the raw range.
+ * Compression runs on the writer thread, overlapped with fetching the next
+ * chunk, so it costs no extra pass over the record.
+ */
+TEEC_Result adi_memdump_stream_compressed(memdump_session_t *session, uint32_t record, uint64_t start,
+					  uint64_t length, enum memdump_endian convert, enum memdump_compress compress, memdump_sink_t sink,
+					  void *arg, memdump_record_info_t *info)
+{
+	TEEC_Result res;
+	struct compress_sink_arg stage = {
+		.sink = sink,
+		.arg = arg,
+	};
+
+	if (!memdump_compressor_init(&stage.compressor, compress, MEMDUMP_CHUNK_SIZE))
+		return TEEC_ERROR_OUT_OF_MEMORY;
+
+	if (!compress_out(&stage, memdump_compress_begin(&stage.compressor))) {
+		res = TEEC_ERROR_GENERIC;
+		goto end;
+	}
+
+	res = adi_memdump_stream_range(session, record, start, length, convert, compress_sink, &stage, info);
+	if (res == TEEC_SUCCESS && !compress_out(&stage, memdump_compress_end(&stage.compressor)))
+		res = TEEC_ERROR_GENERIC;
+
+end:
+	memdump_compressor_free(&stage.compressor);
+
+	return res;
+}
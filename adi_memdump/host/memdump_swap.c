@@ -0,0 +1,310 @@
+/*
+ * Copyright (c) 2026, Analog Devices Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <tmmintrin.h>
+#endif
+
+#include "memdump_swap.h"
+
+/**
+ * memdump_width_bytes - access width of a record in bytes, 0 if not valid
+ *
+ * The TA reports the width as a byte count: 1, 2, 4 or 8.
+ */
+unsigned int memdump_width_bytes(uint32_t width)
+{
+	switch (width) {
+	case 1:
+	case 2:
+	case 4:
+	case 8:
+		return width;
+	default:
+		return 0;
+	}
+}
+
+/**
+ * memdump_convert_width - word size to byte swap a record by
+ *
+ * *endianness is the endianness the TA reported for the record, and is
+ * updated to that of the data after conversion. *swap is 0 if the data is
+ * written as it is. A conversion is refused, returning false, for a width
+ * that is not a valid byte count rather than guessing the word size, and
+ * when start, the record offset of the first byte, splits a word.
+ */
+bool memdump_convert_width(enum memdump_endian convert, uint32_t width, uint64_t start, uint32_t *endianness,
+			   unsigned int *swap)
+{
+	unsigned int bytes = memdump_width_bytes(width);
+	uint32_t target;
+
+	*swap = 0;
+	if (convert == MEMDUMP_CONVERT_NONE)
+		return true;
+	if (bytes == 0) {
+		printf("Record width %u is not 1, 2, 4 or 8 bytes, unable to convert its endianness\n", width);
+		return false;
+	}
+
+	switch (convert) {
+	case MEMDUMP_CONVERT_LITTLE:
+		target = MEMDUMP_ENDIAN_LITTLE;
+		break;
+	case MEMDUMP_CONVERT_BIG:
+		target = MEMDUMP_ENDIAN_BIG;
+		break;
+	default:
+		target = MEMDUMP_ENDIAN_HOST;
+		break;
+	}
+
+	if (*endianness != target && bytes > 1) {
+		if (start % bytes != 0) {
+			printf("Offset 0x%llx is not a multiple of the record width %u, unable to convert its endianness\n",
+			       (unsigned long long)start, bytes);
+			return false;
+		}
+		*swap = bytes;
+	}
+	*endianness = target;
+
+	return true;
+}
+
+/**
+ * memdump_bswap_scalar - reverse the bytes of every width byte word, one word at a time
+ *
+ * Trailing bytes that do not make a whole word are left alone.
+ */
+void memdump_bswap_scalar(uint8_t *data, size_t len, unsigned int width)
+{
+	uint16_t v16;
+	uint32_t v32;
+	uint64_t v64;
+	size_t i;
+
+	switch (width) {
+	case 2:
+		for (i = 0; i + 2 <= len; i += 2) {
+			memcpy(&v16, data + i, 2);
+			v16 = __builtin_bswap16(v16);
+			memcpy(data + i, &v16, 2);
+		}
+		break;
+	case 4:
+		for (i = 0; i + 4 <= len; i += 4) {
+			memcpy(&v32, data + i, 4);
+			v32 = __builtin_bswap32(v32);
+			memcpy(data + i, &v32, 4);
+		}
+		break;
+	case 8:
+		for (i = 0; i + 8 <= len; i += 8) {
+			memcpy(&v64, data + i, 8);
+			v64 = __builtin_bswap64(v64);
+			memcpy(data + i, &v64, 8);
+		}
+		break;
+	default:
+		break;
+	}
+}
+
+#if defined(__ARM_NEON)
+/**
+ * bswap_vector - NEON byte reversal of whole 64 byte blocks, returns bytes done
+ */
+static size_t bswap_vector(uint8_t *data, size_t len, unsigned int width)
+{
+	uint8x16_t v;
+	size_t i;
+
+	for (i = 0; i + 64 <= len; i += 64) {
+		for (int k = 0; k < 64; k += 16) {
+			v = vld1q_u8(data + i + k);
+			v = (width == 2) ? vrev16q_u8(v) : (width == 4) ? vrev32q_u8(v) : vrev64q_u8(v);
+			vst1q_u8(data + i + k, v);
+		}
+	}
+
+	return i;
+}
+
+/**
+ * have_vector - whether bswap_vector() runs on this CPU
+ */
+static bool have_vector(void)
+{
+	return true;
+}
+#elif defined(__x86_64__) || defined(__i386__)
+/**
+ * bswap_vector - SSSE3 byte reversal of whole 64 byte blocks, returns bytes done
+ *
+ * Built for SSSE3 whatever the compiler target, and only called when the CPU
+ * has it.
+ */
+__attribute__((target("ssse3"))) static size_t bswap_vector(uint8_t *data, size_t len, unsigned int width)
+{
+	const __m128i mask = (width == 2) ? _mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14) :
+			     (width == 4) ? _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12) :
+					    _mm_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+	__m128i v;
+	size_t i;
+
+	for (i = 0; i + 64 <= len; i += 64) {
+		for (int k = 0; k < 64; k += 16) {
+			v = _mm_loadu_si128((const __m128i *)(data + i + k));
+			_mm_storeu_si128((__m128i *)(data + i + k), _mm_shuffle_epi8(v, mask));
+		}
+	}
+
+	return i;
+}
+
+/**
+ * have_vector - whether bswap_vector() runs on this CPU
+ */
+static bool have_vector(void)
+{
+	return __builtin_cpu_supports("ssse3");
+}
+#else
+static size_t bswap_vector(uint8_t *data, size_t len, unsigned int width)
+{
+	return 0;
+}
+
+static bool have_vector(void)
+{
+	return false;
+}
+#endif
+
+/**
+ * memdump_bswap - reverse the bytes of every width byte word
+ *
+ * Whole 64 byte blocks go through NEON or SSSE3 where the CPU has them, the
+ * tail and other CPUs through the scalar loop.
+ */
+void memdump_bswap(uint8_t *data, size_t len, unsigned int width)
+{
+	size_t i = 0;
+
+	if (width != 2 && width != 4 && width != 8)
+		return;
+
+	if (have_vector())
+		i = bswap_vector(data, len, width);
+
+	memdump_bswap_scalar(data + i, len - i, width);
+}
+
+/**
+ * memdump_bswap_impl - name of the implementation memdump_bswap() uses
+ */
+const char *memdump_bswap_impl(void)
+{
+#if defined(__ARM_NEON)
+	return "neon";
+#elif defined(__x86_64__) || defined(__i386__)
+	return have_vector() ? "ssse3" : "scalar";
+#else
+	return "scalar";
+#endif
+}
+
+/**
+ * bench_mibs - MiB/s of one swap implementation over buf
+ */
+static double bench_mibs(void (*swap)(uint8_t *, size_t, unsigned int), uint8_t *buf, size_t len,
+			 unsigned int width, unsigned int rounds)
+{
+	struct timespec t0, t1;
+	double secs;
+	unsigned int i;
+
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+	for (i = 0; i < rounds; i++)
+		swap(buf, len, width);
+	clock_gettime(CLOCK_MONOTONIC, &t1);
+
+	secs = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+	return secs > 0 ? (double)len * rounds / (1024 * 1024) / secs : 0;
+}
+
+/**
+ * memdump_bswap_benchmark - compare memdump_bswap() against the scalar loop
+ *
+ * Runs on the host only, no TA session is opened. Returns false if the
+ * buffer could not be allocated or the two implementations disagree.
+ */
+bool memdump_bswap_benchmark(size_t len, unsigned int rounds)
+{
+	static const unsigned int widths[] = { 2, 4, 8 };
+	uint8_t *buf, *ref;
+	bool ok = true;
+	unsigned int i;
+	size_t j;
+
+	buf = malloc(len);
+	ref = malloc(len);
+	if (buf == NULL || ref == NULL) {
+		printf("Failed to allocate 0x%zx byte benchmark buffer.\n", len);
+		free(buf);
+		free(ref);
+		return false;
+	}
+	for (j = 0; j < len; j++)
+		buf[j] = ref[j] = (uint8_t)(j * 131 + (j >> 8));
+
+	printf("byte swap: %s, 0x%zx bytes x %u\n", memdump_bswap_impl(), len, rounds);
+	for (i = 0; i < sizeof(widths) / sizeof(widths[0]); i++) {
+		double scalar = bench_mibs(memdump_bswap_scalar, ref, len, widths[i], rounds);
+		double vector = bench_mibs(memdump_bswap, buf, len, widths[i], rounds);
+
+		printf("  width %u: scalar %.0f MiB/s, memdump_bswap %.0f MiB/s\n", widths[i], scalar, vector);
+		if (memcmp(buf, ref, len) != 0) {
+			printf("  width %u: implementations disagree\n", widths[i]);
+			ok = false;
+		}
+	}
+
+	free(buf);
+	free(ref);
+	return ok;
+}
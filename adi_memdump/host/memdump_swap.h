@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2026, Analog Devices Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef MEMDUMP_SWAP_H
+#define MEMDUMP_SWAP_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Endianness of record data, as reported by the memdump TA */
+#define MEMDUMP_ENDIAN_LITTLE 0
+#define MEMDUMP_ENDIAN_BIG 1
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#define MEMDUMP_ENDIAN_HOST MEMDUMP_ENDIAN_BIG
+#else
+#define MEMDUMP_ENDIAN_HOST MEMDUMP_ENDIAN_LITTLE
+#endif
+
+/* Endianness a record is converted to while it is dumped */
+enum memdump_endian {
+	MEMDUMP_CONVERT_NONE,   /* Write the data as the TA returns it */
+	MEMDUMP_CONVERT_HOST,
+	MEMDUMP_CONVERT_LITTLE,
+	MEMDUMP_CONVERT_BIG,
+};
+
+unsigned int memdump_width_bytes(uint32_t width);
+bool memdump_convert_width(enum memdump_endian convert, uint32_t width, uint64_t start, uint32_t *endianness,
+			   unsigned int *swap);
+void memdump_bswap(uint8_t *data, size_t len, unsigned int width);
+void memdump_bswap_scalar(uint8_t *data, size_t len, unsigned int width);
+const char *memdump_bswap_impl(void);
+bool memdump_bswap_benchmark(size_t len, unsigned int rounds);
+
+#endif /* MEMDUMP_SWAP_H */
@@ -0,0 +1,566 @@
+/*
+ * Copyright (c) 2026, Analog Devices Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "archive.h"
+
+/* First letters of the level names, as written in the lines */
+static const char level_letter[RUNTIME_LOG_LEVEL_COUNT] = {
+	[RUNTIME_LOG_LEVEL_ERROR] = 'E',
+	[RUNTIME_LOG_LEVEL_WARNING] = 'W',
+	[RUNTIME_LOG_LEVEL_INFO] = 'I',
+	[RUNTIME_LOG_LEVEL_DEBUG] = 'D',
+};
+
+/**
+ * write_all - write len bytes, resuming after partial writes
+ */
+static bool write_all(int fd, const void *buf, size_t len)
+{
+	const char *p = buf;
+	ssize_t n;
+
+	while (len > 0) {
+		n = write(fd, p, len);
+		if (n < 0) {
+			if (errno == EINTR)
+				continue;
+			return false;
+		}
+		p += n;
+		len -= n;
+	}
+
+	return true;
+}
+
+/**
+ * segment_path - path of segment number of an archive, ext "log" or "idx"
+ */
+static bool segment_path(char path[PATH_MAX], const char *dir, unsigned int number, const char *ext)
+{
+	return snprintf(path, PATH_MAX, "%s/%08u.%s", dir, number, ext) < PATH_MAX;
+}
+
+/**
+ * find_segments - oldest and newest segment numbers in an archive
+ *
+ * Returns false, with *first and *last at 0, if there are none.
+ */
+static bool find_segments(const char *dir, unsigned int *first, unsigned int *last)
+{
+	struct dirent *de;
+	unsigned long number;
+	bool found = false;
+	char *end;
+	DIR *d;
+
+	*first = 0;
+	*last = 0;
+
+	d = opendir(dir);
+	if (d == NULL)
+		return false;
+
+	while ((de = readdir(d)) != NULL) {
+		if (strlen(de->d_name) != 12 || strcmp(de->d_name + 8, ".log") != 0)
+			continue;
+		number = strtoul(de->d_name, &end, 10);
+		if (end != de->d_name + 8 || number > UINT_MAX)
+			continue;
+		if (!found || number < *first)
+			*first = number;
+		if (!found || number > *last)
+			*last = number;
+		found = true;
+	}
+	closedir(d);
+
+	return found;
+}
+
+/**
+ * open_segment - open the current segment and its index for appending
+ */
+static bool open_segment(archive_t *archive)
+{
+	char path[PATH_MAX];
+	struct stat st;
+
+	if (!segment_path(path, archive->dir, archive->current, "log"))
+		return false;
+	archive->fd = open(path, O_WRONLY | O_CREAT | O_APPEND, 0640);
+	if (archive->fd < 0 || fstat(archive->fd, &st) != 0) {
+		printf("Unable to open file %s\n", path);
+		goto err;
+	}
+	archive->size = st.st_size;
+
+	if (!segment_path(path, archive->dir, archive->current, "idx"))
+		goto err;
+	archive->idx_fd = open(path, O_WRONLY | O_CREAT | O_APPEND, 0640);
+	if (archive->idx_fd < 0) {
+		printf("Unable to open file %s\n", path);
+		goto err;
+	}
+
+	return true;
+
+err:
+	if (archive->fd >= 0)
+		close(archive->fd);
+	archive->fd = -1;
+	return false;
+}
+
+/**
+ * prune - delete the segments past the number kept
+ */
+static void prune(archive_t *archive)
+{
+	char path[PATH_MAX];
+
+	for (; archive->current - archive->first >= archive->segments; archive->first++) {
+		if (segment_path(path, archive->dir, archive->first, "log"))
+			unlink(path);
+		if (segment_path(path, archive->dir, archive->first, "idx"))
+			unlink(path);
+	}
+}
+
+/**
+ * archive_open - Open an archive for appending, creating its directory if needed
+ *
+ * Appending continues in the newest segment.
+ */
+bool archive_open(archive_t *archive, const char *dir, size_t segment_size, unsigned int segments)
+{
+	if (mkdir(dir, 0750) != 0 && errno != EEXIST) {
+		printf("Unable to create directory %s\n", dir);
+		return false;
+	}
+
+	memset(&archive->block, 0, sizeof(archive->block));
+	archive->dir = dir;
+	archive->segment_size = segment_size;
+	archive->segments = segments;
+	archive->fd = -1;
+	archive->idx_fd = -1;
+	archive->buf_len = 0;
+	find_segments(dir, &archive->first, &archive->current);
+
+	if (!open_segment(archive))
+		return false;
+	prune(archive);
+
+	return true;
+}
+
+/**
+ * archive_flush - Write the buffered lines and close the block being written
+ */
+bool archive_flush(archive_t *archive)
+{
+	if (archive->buf_len > 0) {
+		if (!write_all(archive->fd, archive->buf, archive->buf_len)) {
+			printf("Unable to write archive %s: %s\n", archive->dir, strerror(errno));
+			return false;
+		}
+		archive->buf_len = 0;
+	}
+
+	/* Index the block only once its lines are in the segment */
+	if (archive->block.lines > 0) {
+		if (!write_all(archive->idx_fd, &archive->block, sizeof(archive->block))) {
+			printf("Unable to write archive %s: %s\n", archive->dir, strerror(errno));
+			return false;
+		}
+		memset(&archive->block, 0, sizeof(archive->block));
+	}
+
+	return true;
+}
+
+/**
+ * rotate - move on to the next segment, deleting the oldest past the number kept
+ */
+static bool rotate(archive_t *archive)
+{
+	if (!archive_flush(archive))
+		return false;
+	close(archive->fd);
+	close(archive->idx_fd);
+	archive->fd = -1;
+	archive->idx_fd = -1;
+
+	archive->current++;
+	if (!open_segment(archive))
+		return false;
+	prune(archive);
+
+	return true;
+}
+
+/**
+ * archive_append - Add an entry to the archive
+ *
+ * Newlines inside the entry are written as spaces to keep one line per entry.
+ */
+bool archive_append(archive_t *archive, uint64_t time, enum runtime_log_id log, enum runtime_log_level level,
+		    uint64_t seq, const char *entry, size_t len)
+{
+	char head[80];
+	size_t line_len;
+	char *p;
+	int n;
+
+	if (len > ARCHIVE_BUFFER_SIZE - sizeof(head) - 1)
+		len = ARCHIVE_BUFFER_SIZE - sizeof(head) - 1;
+
+	if (seq == ARCHIVE_SEQ_NONE)
+		n = snprintf(head, sizeof(head), "%llu.%09llu %s %c - ", (unsigned long long)(time / 1000000000),
+			     (unsigned long long)(time % 1000000000), runtime_log_name(log), level_letter[level]);
+	else
+		n = snprintf(head, sizeof(head), "%llu.%09llu %s %c %llu ", (unsigned long long)(time / 1000000000),
+			     (unsigned long long)(time % 1000000000), runtime_log_name(log), level_letter[level],
+			     (unsigned long long)seq);
+	line_len = n + len + 1;
+
+	if (archive->size > 0 && archive->size + line_len > archive->segment_size && !rotate(archive))
+		return false;
+	if (archive->buf_len + line_len > sizeof(archive->buf)) {
+		/* Written without closing the block, it is indexed once complete */
+		if (!write_all(archive->fd, archive->buf, archive->buf_len)) {
+			printf("Unable to write archive %s: %s\n", archive->dir, strerror(errno));
+			return false;
+		}
+		archive->buf_len = 0;
+	}
+
+	p = archive->buf + archive->buf_len;
+	memcpy(p, head, n);
+	p += n;
+	for (size_t i = 0; i < len; i++)
+		p[i] = (entry[i] == '\n') ? ' ' : entry[i];
+	p[len] = '\n';
+	archive->buf_len += line_len;
+
+	if (archive->block.lines == 0) {
+		archive->block.offset = archive->size;
+		archive->block.first = time;
+		archive->block.last = time;
+	}
+	if (time < archive->block.first)
+		archive->block.first = time;
+	if (time > archive->block.last)
+		archive->block.last = time;
+	archive->block.length += line_len;
+	archive->block.levels |= 1u << level;
+	archive->size += line_len;
+
+	if (++archive->block.lines == ARCHIVE_BLOCK_LINES)
+		return archive_flush(archive);
+
+	return true;
+}
+
+/**
+ * archive_close - Flush and close an archive
+ */
+void archive_close(archive_t *archive)
+{
+	archive_flush(archive);
+	close(archive->fd);
+	close(archive->idx_fd);
+}
+
+/**
+ * parse_number - parse a decimal number of up to 20 digits
+ */
+static const char *parse_number(const char *p, const char *end, uint64_t *value)
+{
+	const char *start = p;
+
+	*value = 0;
+	for (; p < end && *p >= '0' && *p <= '9' && p - start < 20; p++)
+		*value = *value * 10 + (*p - '0');
+
+	return (p > start) ? p : NULL;
+}
+
+/**
+ * parse_line - split an archived line, without its newline, into its fields
+ */
+static bool parse_line(const char *p, const char *end, archive_line_t *line)
+{
+	uint64_t sec, nsec;
+	size_t n;
+
+	p = parse_number(p, end, &sec);
+	if (p == NULL || p == end || *p != '.')
+		return false;
+	p = parse_number(p + 1, end, &nsec);
+	if (p == NULL || p == end || *p != ' ')
+		return false;
+	line->time = sec * 1000000000ULL + nsec;
+	p++;
+
+	for (line->log = 0; line->log < RUNTIME_LOG_COUNT; line->log++) {
+		n = strlen(runtime_log_name(line->log));
+		if ((size_t)(end - p) > n && memcmp(p, runtime_log_name(line->log), n) == 0 && p[n] == ' ')
+			break;
+	}
+	if (line->log == RUNTIME_LOG_COUNT)
+		return false;
+	p += n + 1;
+
+	if (end - p < 2 || p[1] != ' ')
+		return false;
+	for (line->level = 0; line->level < RUNTIME_LOG_LEVEL_COUNT; line->level++) {
+		if (level_letter[line->level] == *p)
+			break;
+	}
+	if (line->level == RUNTIME_LOG_LEVEL_COUNT)
+		return false;
+	p += 2;
+
+	if (p < end && *p == '-') {
+		line->seq = ARCHIVE_SEQ_NONE;
+		p++;
+	} else {
+		p = parse_number(p, end, &line->seq);
+		if (p == NULL)
+			return false;
+	}
+	if (p == end || *p != ' ')
+		return false;
+	p++;
+
+	line->entry = p;
+	line->len = end - p;
+
+	return true;
+}
+
+/* Map of a segment */
+struct segment_map {
+	int fd;
+	char *data;
+	size_t size;
+};
+
+/**
+ * map_segment - map a segment read-only; an empty segment maps to no data
+ */
+static bool map_segment(const char *dir, unsigned int number, struct segment_map *map)
+{
+	char path[PATH_MAX];
+	struct stat st;
+
+	map->data = NULL;
+	map->size = 0;
+	if (!segment_path(path, dir, number, "log"))
+		return false;
+	map->fd = open(path, O_RDONLY);
+	if (map->fd < 0)
+		return false;
+	if (fstat(map->fd, &st) != 0) {
+		close(map->fd);
+		return false;
+	}
+	map->size = st.st_size;
+	if (map->size == 0)
+		return true;
+
+	map->data = mmap(NULL, map->size, PROT_READ, MAP_PRIVATE, map->fd, 0);
+	if (map->data == MAP_FAILED) {
+		printf("Unable to map file %s\n", path);
+		close(map->fd);
+		return false;
+	}
+
+	return true;
+}
+
+static void unmap_segment(struct segment_map *map)
+{
+	if (map->data != NULL)
+		munmap(map->data, map->size);
+	close(map->fd);
+}
+
+/**
+ * archive_scan_last - Pass every line of the newest segment to cb, in order
+ */
+bool archive_scan_last(const char *dir, archive_line_cb cb, void *arg)
+{
+	struct segment_map map;
+	archive_line_t line;
+	unsigned int first, last;
+	const char *p, *end, *nl;
+
+	if (!find_segments(dir, &first, &last))
+		return true;
+	if (!map_segment(dir, last, &map))
+		return false;
+
+	end = map.data + map.size;
+	for (p = map.data; p < end; p = nl + 1) {
+		nl = memchr(p, '\n', end - p);
+		if (nl == NULL)
+			break;
+		if (parse_line(p, nl, &line))
+			cb(arg, &line);
+	}
+	unmap_segment(&map);
+
+	return true;
+}
+
+/* Filter of archive_query */
+struct query {
+	uint64_t since;
+	uint64_t until;
+	enum runtime_log_level level;
+	int fd;
+};
+
+/**
+ * query_range - write the lines of [p, end) that pass the filter
+ *
+ * Consecutive matching lines go out in one write.
+ */
+static bool query_range(const struct query *q, const char *p, const char *end)
+{
+	const char *run = p;
+	archive_line_t line;
+	const char *nl;
+
+	for (; p < end; p = nl + 1) {
+		nl = memchr(p, '\n', end - p);
+		if (nl == NULL)
+			nl = end - 1;
+		if (parse_line(p, nl, &line) && line.time >= q->since && line.time <= q->until &&
+		    line.level <= q->level)
+			continue;
+		if (p > run && !write_all(q->fd, run, p - run))
+			return false;
+		run = nl + 1;
+	}
+	if (end > run && !write_all(q->fd, run, end - run))
+		return false;
+
+	return true;
+}
+
+/**
+ * query_segment - write the matching lines of one segment
+ *
+ * Blocks whose time range or levels do not match are skipped without reading
+ * them. Lines not covered by the index are filtered one by one.
+ */
+static bool query_segment(const char *dir, unsigned int number, const struct query *q)
+{
+	char path[PATH_MAX];
+	struct segment_map map;
+	archive_index_t *index = NULL;
+	size_t count = 0;
+	size_t covered = 0;
+	struct stat st;
+	uint32_t mask = (2u << q->level) - 1;
+	bool ok = true;
+	int fd;
+
+	if (!map_segment(dir, number, &map))
+		return true;        /* Deleted by a collector since the directory was read */
+
+	if (segment_path(path, dir, number, "idx") && (fd = open(path, O_RDONLY)) >= 0) {
+		if (fstat(fd, &st) == 0 && st.st_size >= (off_t)sizeof(*index)) {
+			count = st.st_size / sizeof(*index);
+			index = malloc(count * sizeof(*index));
+			if (index == NULL || pread(fd, index, count * sizeof(*index), 0) !=
+						     (ssize_t)(count * sizeof(*index)))
+				count = 0;
+		}
+		close(fd);
+	}
+
+	for (size_t i = 0; ok && i < count; i++) {
+		const archive_index_t *block = &index[i];
+
+		if (block->offset < covered || (size_t)block->offset + block->length > map.size)
+			break;
+		if (block->offset > covered)
+			ok = query_range(q, map.data + covered, map.data + block->offset);
+		if (ok && block->last >= q->since && block->first <= q->until && (block->levels & mask) != 0)
+			ok = query_range(q, map.data + block->offset, map.data + block->offset + block->length);
+		covered = block->offset + block->length;
+	}
+	if (ok && covered < map.size)
+		ok = query_range(q, map.data + covered, map.data + map.size);
+
+	if (!ok)
+		printf("Unable to write the archive lines: %s\n", strerror(errno));
+	free(index);
+	unmap_segment(&map);
+
+	return ok;
+}
+
+/**
+ * archive_query - Write the archived lines collected between since and until,
+ * both included, at level or more severe
+ */
+bool archive_query(const char *dir, uint64_t since, uint64_t until, enum runtime_log_level level, int fd)
+{
+	struct query q = { .since = since, .until = until, .level = level, .fd = fd };
+	unsigned int first, last;
+
+	if (access(dir, F_OK) != 0) {
+		printf("Unable to open archive %s\n", dir);
+		return false;
+	}
+	if (!find_segments(dir, &first, &last))
+		return true;
+
+	for (unsigned int number = first; number <= last; number++) {
+		if (!query_segment(dir, number, &q))
+			return false;
+	}
+
+	return true;
+}
@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2026, Analog Devices Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef ARCHIVE_H
+#define ARCHIVE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "runtime_log.h"
+
+/*
+ * The archive is a directory of numbered segments, NNNNNNNN.log, each with an
+ * index NNNNNNNN.idx. A segment holds one text line per entry:
+ *
+ *   <sec>.<nsec> <log> <level> <seq|-> <entry>
+ *
+ * The time is when the entry was collected, in CLOCK_REALTIME, so it keeps
+ * increasing across reboots. seq is the sequence number past the entry, "-"
+ * when the TA has no read cursors. The level is the first letter of its name.
+ *
+ * The index has one archive_index_t per block of up to ARCHIVE_BLOCK_LINES
+ * lines, written once the block is in the segment. Lines after the last
+ * indexed block, e.g. after a crash, are still found by a query.
+ */
+
+/* Default size of a segment before the archive moves to the next one */
+#define ARCHIVE_SEGMENT_SIZE_DEFAULT (1024 * 1024)
+
+/* Default number of segments kept, the oldest is deleted */
+#define ARCHIVE_SEGMENTS_DEFAULT 8
+
+/* Most lines per index record */
+#define ARCHIVE_BLOCK_LINES 256
+
+/* Lines buffered before they are written */
+#define ARCHIVE_BUFFER_SIZE (64 * 1024)
+
+/* seq of an entry fetched without read cursors */
+#define ARCHIVE_SEQ_NONE UINT64_MAX
+
+/* Index record of a block of lines */
+typedef struct archive_index {
+	uint64_t first;                 /* Earliest time in the block, ns */
+	uint64_t last;                  /* Latest time in the block, ns */
+	uint32_t offset;                /* Position of the block in the segment */
+	uint32_t length;
+	uint32_t lines;
+	uint32_t levels;                /* Bit per runtime_log_level in the block */
+} archive_index_t;
+
+/* Archive open for appending */
+typedef struct archive {
+	const char *dir;
+	size_t segment_size;
+	unsigned int segments;
+	unsigned int first;             /* Oldest segment kept */
+	unsigned int current;           /* Segment being written */
+	int fd;
+	int idx_fd;
+	size_t size;                    /* Bytes in the current segment, buffered ones included */
+	archive_index_t block;          /* Block being written */
+	size_t buf_len;
+	char buf[ARCHIVE_BUFFER_SIZE];
+} archive_t;
+
+/* One archived line */
+typedef struct archive_line {
+	uint64_t time;
+	enum runtime_log_id log;
+	enum runtime_log_level level;
+	uint64_t seq;
+	const char *entry;
+	size_t len;
+} archive_line_t;
+
+typedef void (*archive_line_cb)(void *arg, const archive_line_t *line);
+
+bool archive_open(archive_t *archive, const char *dir, size_t segment_size, unsigned int segments);
+bool archive_append(archive_t *archive, uint64_t time, enum runtime_log_id log, enum runtime_log_level level,
+		    uint64_t seq, const char *entry, size_t len);
+bool archive_flush(archive_t *archive);
+void archive_close(archive_t *archive);
+
+bool archive_scan_last(const char *dir, archive_line_cb cb, void *arg);
+bool archive_query(const char *dir, uint64_t since, uint64_t until, enum runtime_log_level level, int fd);
+
+#endif /* ARCHIVE_H */
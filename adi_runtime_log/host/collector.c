@@ -0,0 +1,386 @@
+/*
+ * Copyright (c) 2026, Analog Devices Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <err.h>
+#include <limits.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "archive.h"
+#include "collector.h"
+
+#define DEDUPE_SLOTS (2 * COLLECTOR_DEDUPE_KEYS)
+
+#define FNV_OFFSET 0xcbf29ce484222325ULL
+#define FNV_PRIME 0x100000001b3ULL
+
+/* Changes on every boot of the board, and so of the secure world */
+#define BOOT_ID_PATH "/proc/sys/kernel/random/boot_id"
+
+/*
+ * Keys of the entries archived most recently. The table finds a key, the
+ * FIFO evicts the oldest once COLLECTOR_DEDUPE_KEYS are kept.
+ */
+struct dedupe {
+	uint64_t slots[DEDUPE_SLOTS];   /* Open addressing, 0 is free */
+	uint64_t fifo[COLLECTOR_DEDUPE_KEYS];
+	unsigned int head;
+	unsigned int count;
+	uint64_t window[RUNTIME_LOG_COUNT][COLLECTOR_WINDOW];   /* Hashes of the last entries */
+};
+
+struct collector {
+	archive_t archive;
+	struct dedupe seen;
+	uint64_t now;                   /* Collection time of this poll */
+	uint32_t capacity[RUNTIME_LOG_COUNT];   /* Log sizes, without read cursors */
+	bool failed;
+};
+
+static volatile sig_atomic_t stop;
+
+static void handle_signal(int signal)
+{
+	stop = 1;
+}
+
+static uint64_t fnv(uint64_t h, const void *data, size_t len)
+{
+	const unsigned char *p = data;
+
+	for (size_t i = 0; i < len; i++)
+		h = (h ^ p[i]) * FNV_PRIME;
+
+	return h;
+}
+
+/**
+ * entry_key - key of an entry from (log, sequence number or timestamp, text)
+ *
+ * The sequence number identifies an entry exactly. Without read cursors, the
+ * timestamp is used instead, and an entry that has none is keyed by the
+ * entries before it: a rolling window of the hashes of the last
+ * COLLECTOR_WINDOW entries of its log.
+ */
+static uint64_t entry_key(struct dedupe *seen, enum runtime_log_id log, uint64_t seq, const char *entry, size_t len)
+{
+	uint64_t *window = seen->window[log];
+	uint8_t id = log;
+	uint64_t ns;
+	uint64_t h;
+
+	h = fnv(FNV_OFFSET, &id, 1);
+	if (seq != ARCHIVE_SEQ_NONE) {
+		h = fnv(h, "s", 1);
+		h = fnv(h, &seq, sizeof(seq));
+	} else if (runtime_log_entry_time(entry, len, &ns)) {
+		h = fnv(h, "t", 1);
+		h = fnv(h, &ns, sizeof(ns));
+	} else {
+		h = fnv(h, "w", 1);
+		h = fnv(h, window, COLLECTOR_WINDOW * sizeof(*window));
+	}
+	h = fnv(h, entry, len);
+
+	memmove(window + 1, window, (COLLECTOR_WINDOW - 1) * sizeof(*window));
+	window[0] = fnv(FNV_OFFSET, entry, len);
+
+	return h ? h : 1;
+}
+
+static unsigned int dedupe_slot(const struct dedupe *seen, uint64_t key)
+{
+	unsigned int i = key & (DEDUPE_SLOTS - 1);
+
+	while (seen->slots[i] != 0 && seen->slots[i] != key)
+		i = (i + 1) & (DEDUPE_SLOTS - 1);
+
+	return i;
+}
+
+static bool dedupe_find(const struct dedupe *seen, uint64_t key)
+{
+	return seen->slots[dedupe_slot(seen, key)] == key;
+}
+
+/**
+ * dedupe_remove - remove a key, moving back the keys probed past it
+ */
+static void dedupe_remove(struct dedupe *seen, uint64_t key)
+{
+	unsigned int i = dedupe_slot(seen, key);
+	unsigned int j = i;
+	unsigned int home;
+
+	if (seen->slots[i] != key)
+		return;
+
+	for (;;) {
+		j = (j + 1) & (DEDUPE_SLOTS - 1);
+		if (seen->slots[j] == 0)
+			break;
+		home = seen->slots[j] & (DEDUPE_SLOTS - 1);
+		/* Move the key back unless its home slot is in (i, j] */
+		if ((j > i && (home <= i || home > j)) || (j < i && home <= i && home > j)) {
+			seen->slots[i] = seen->slots[j];
+			i = j;
+		}
+	}
+	seen->slots[i] = 0;
+}
+
+static void dedupe_insert(struct dedupe *seen, uint64_t key)
+{
+	if (seen->count == COLLECTOR_DEDUPE_KEYS) {
+		dedupe_remove(seen, seen->fifo[seen->head]);
+		seen->fifo[seen->head] = key;
+		seen->head = (seen->head + 1) % COLLECTOR_DEDUPE_KEYS;
+	} else {
+		seen->fifo[(seen->head + seen->count++) % COLLECTOR_DEDUPE_KEYS] = key;
+	}
+	seen->slots[dedupe_slot(seen, key)] = key;
+}
+
+/**
+ * collect_entry - archive an entry unless it was already archived
+ */
+static void collect_entry(struct collector *c, enum runtime_log_id log, uint64_t seq, const char *entry, size_t len)
+{
+	uint64_t key = entry_key(&c->seen, log, seq, entry, len);
+
+	if (dedupe_find(&c->seen, key))
+		return;
+	dedupe_insert(&c->seen, key);
+
+	if (!c->failed &&
+	    !archive_append(&c->archive, c->now, log, runtime_log_entry_level(entry, len), seq, entry, len))
+		c->failed = true;
+}
+
+/**
+ * emit_entry - runtime_log_emit_t of the readers
+ */
+static void emit_entry(void *arg, enum runtime_log_id log, uint64_t seq, const char *entry, size_t len)
+{
+	collect_entry(arg, log, seq, entry, len);
+}
+
+/**
+ * seed_line - archive_line_cb adding the key of an archived line
+ */
+static void seed_line(void *arg, const archive_line_t *line)
+{
+	struct dedupe *seen = arg;
+	uint64_t key = entry_key(seen, line->log, line->seq, line->entry, line->len);
+
+	if (!dedupe_find(seen, key))
+		dedupe_insert(seen, key);
+}
+
+/**
+ * collect_whole - archive the new entries of the whole logs
+ *
+ * Used when the TA has no read cursors. Every poll fetches the whole logs
+ * again; what was already archived is dropped by its key. A full log has
+ * wrapped and starts inside an entry, which is skipped.
+ */
+static bool collect_whole(struct collector *c, runtime_log_session_t *session)
+{
+	char *data[RUNTIME_LOG_COUNT];
+	uint32_t size[RUNTIME_LOG_COUNT];
+	char *p, *q, *end;
+
+	if (runtime_log_get(session, data, size) != TEEC_SUCCESS)
+		return false;
+
+	/* The windows start over with the oldest entry of each buffer */
+	memset(c->seen.window, 0, sizeof(c->seen.window));
+	for (int i = 0; i < RUNTIME_LOG_COUNT; i++) {
+		end = data[i] + size[i];
+		p = data[i];
+		if (size[i] >= c->capacity[i]) {
+			p = memchr(p, GROUP_SEPARATOR, size[i]);
+			if (p == NULL)
+				continue;
+		}
+		for (; p < end; p = q) {
+			if (*p == '\0' || *p == GROUP_SEPARATOR) {
+				q = p + 1;
+				continue;
+			}
+			for (q = p; q < end && *q != '\0' && *q != GROUP_SEPARATOR; q++)
+				;
+			collect_entry(c, i, ARCHIVE_SEQ_NONE, p, q - p);
+		}
+	}
+
+	return true;
+}
+
+/**
+ * read_boot_id - boot id of the board, empty if it cannot be read
+ */
+static void read_boot_id(const char *path, char id[64])
+{
+	FILE *fp = fopen(path, "r");
+
+	id[0] = '\0';
+	if (fp == NULL)
+		return;
+	if (fgets(id, 64, fp) == NULL)
+		id[0] = '\0';
+	fclose(fp);
+}
+
+/**
+ * runtime_log_collect - Archive new entries of the logs until interrupted
+ *
+ * Polls every period ms with incremental reads, or by fetching the whole logs
+ * if the TA has no read cursors, and appends what is new to the archive in
+ * dir. The read position is kept in dir/cursor with the boot it belongs to
+ * in dir/boot_id: after a reboot the logs are collected from their oldest
+ * entry again. On the same boot, the keys of the newest segment are loaded so
+ * that entries archived after the cursor was last saved are not repeated.
+ */
+int runtime_log_collect(runtime_log_session_t *session, const char *dir, unsigned int period, size_t segment_size,
+			unsigned int segments)
+{
+	runtime_log_reader_t readers[RUNTIME_LOG_COUNT];
+	uint64_t seq[RUNTIME_LOG_COUNT] = { 0 };
+	uint64_t saved[RUNTIME_LOG_COUNT];
+	uint64_t lost[RUNTIME_LOG_COUNT] = { 0 };
+	char cursor_path[PATH_MAX];
+	char boot_path[PATH_MAX];
+	char boot_id[64];
+	char archived_id[64];
+	struct sigaction sa;
+	struct collector *c;
+	struct timespec ts;
+	bool cursors = true;
+	TEEC_Result res;
+	int ready = 0;
+	int ret = 1;
+	FILE *fp;
+
+	if (snprintf(cursor_path, sizeof(cursor_path), "%s/cursor", dir) >= (int)sizeof(cursor_path) ||
+	    snprintf(boot_path, sizeof(boot_path), "%s/boot_id", dir) >= (int)sizeof(boot_path)) {
+		warnx("Archive path too long: %s", dir);
+		return 1;
+	}
+
+	c = calloc(1, sizeof(*c));
+	if (c == NULL) {
+		warnx("Unable to allocate the collector");
+		return 1;
+	}
+	if (!archive_open(&c->archive, dir, segment_size, segments)) {
+		free(c);
+		return 1;
+	}
+
+	read_boot_id(BOOT_ID_PATH, boot_id);
+	read_boot_id(boot_path, archived_id);
+	if (strcmp(boot_id, archived_id) == 0) {
+		if (!runtime_log_cursor_load(cursor_path, seq) || !archive_scan_last(dir, seed_line, &c->seen))
+			goto end;
+		memset(c->seen.window, 0, sizeof(c->seen.window));
+	} else {
+		/* The cursor first: a crash in between must not resume an old boot */
+		if (!runtime_log_cursor_save(cursor_path, seq))
+			goto end;
+		fp = fopen(boot_path, "w");
+		if (fp == NULL || fputs(boot_id, fp) == EOF || fclose(fp) != 0) {
+			warnx("Unable to write %s", boot_path);
+			goto end;
+		}
+	}
+	memcpy(saved, seq, sizeof(saved));
+
+	for (; ready < RUNTIME_LOG_COUNT; ready++) {
+		res = runtime_log_reader_init(&readers[ready], session, ready, seq[ready]);
+		if (res != TEEC_SUCCESS)
+			goto end;
+	}
+
+	/* Interrupt the poll period on a signal, and stop after a final flush */
+	memset(&sa, 0, sizeof(sa));
+	sa.sa_handler = handle_signal;
+	sigaction(SIGINT, &sa, NULL);
+	sigaction(SIGTERM, &sa, NULL);
+
+	while (!stop) {
+		clock_gettime(CLOCK_REALTIME, &ts);
+		c->now = (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+
+		for (int i = 0; cursors && i < RUNTIME_LOG_COUNT; i++) {
+			res = runtime_log_reader_poll(&readers[i], session, emit_entry, c);
+			if (runtime_log_unknown_cmd(res)) {
+				warnx("the TA has no read cursors, collecting the whole logs");
+				for (int j = 0; j < RUNTIME_LOG_COUNT; j++) {
+					if (runtime_log_get_size(session, j, &c->capacity[j]) != TEEC_SUCCESS)
+						goto end;
+				}
+				cursors = false;
+			} else if (res != TEEC_SUCCESS) {
+				goto end;
+			} else if (readers[i].lost != lost[i]) {
+				warnx("%llu bytes of the %s log were overwritten before they were read",
+				      (unsigned long long)(readers[i].lost - lost[i]), runtime_log_name(i));
+				lost[i] = readers[i].lost;
+			}
+			seq[i] = readers[i].seq;
+		}
+		if (!cursors && !collect_whole(c, session))
+			goto end;
+
+		if (c->failed || !archive_flush(&c->archive))
+			goto end;
+		/* Saved after the entries are in the archive, a crash only repeats them */
+		if (cursors && memcmp(seq, saved, sizeof(seq)) != 0) {
+			if (!runtime_log_cursor_save(cursor_path, seq))
+				goto end;
+			memcpy(saved, seq, sizeof(saved));
+		}
+
+		if (!stop)
+			usleep(period * 1000);
+	}
+
+	ret = 0;
+
+end:
+	while (ready > 0)
+		runtime_log_reader_free(&readers[--ready]);
+	archive_close(&c->archive);
+	free(c);
+
+	return ret;
+}
@@ -26,184 +26,319 @@
  */
 
 #include <err.h>
+#include <fcntl.h>
+#include <getopt.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <time.h>
+#include <unistd.h>
 
-/* OP-TEE TEE client API (built by optee_client) */
-#include <tee_client_api.h>
+#include "archive.h"
+#include "collector.h"
+#include "runtime_log.h"
 
-/*
- * This UUID is generated with uuidgen
- * the ITU-T UUID generator at http://www.itu.int/ITU-T/asn1/uuid.html
- */
-#define TA_SMC_UUID \
-	{ \
-		0x6dc55088, \
-		0x4255, 0x41cc, \
-		{ \
-			0x9b, 0x49, \
-			0x04, 0x53, \
-			0x4e, 0x6a, \
-			0xc3, 0xa6, \
-		} \
-	}
+/* Command help */
+#define HELP "\n\
+Usage:  %1$s \n\
+        %1$s [-C] [-f [-p msec]] [-c cursor-file] [-o file] \n\
+  - without options, print the whole BL31 and OP-TEE logs merged in \n\
+    time order, each line tagged with its log \n\
+  - -C: print the OP-TEE log then the BL31 log, without tags \n\
+  - -c: print only what was logged since the run that last saved \n\
+    cursor-file, then save the new position to it \n\
+  - -f: follow, keep the session open and print new entries as they \n\
+    are logged; starts from the oldest entry kept, or from cursor-file \n\
+  - -p: time between polls with -f or -a, default 1000 \n\
+  - -o: append the logs to file instead of printing them \n\
+        %1$s -a dir [-p msec] [-n segments] [-s KiB] \n\
+  - collect new entries into the archive in dir until interrupted, \n\
+    keeping -n segments of -s KiB, default 8 of 1024 \n\
+        %1$s -q dir [--since time] [--until time] [--level level] [-o file] \n\
+  - print the archived entries collected between --since and --until, \n\
+    in seconds since the epoch or -seconds ago, at --level or more \n\
+    severe: error, warning, info or debug \n\
+\n"
 
-#define OP_PARAM_OPTEE_BUFFER 0
-#define OP_PARAM_BL31_BUFFER 1
+/* Long options only */
+enum {
+	OPT_SINCE = 256,
+	OPT_UNTIL,
+	OPT_LEVEL,
+};
+
+static const struct option long_options[] = {
+	{ "archive", required_argument, NULL, 'a' },
+	{ "query", required_argument, NULL, 'q' },
+	{ "since", required_argument, NULL, OPT_SINCE },
+	{ "until", required_argument, NULL, OPT_UNTIL },
+	{ "level", required_argument, NULL, OPT_LEVEL },
+	{ NULL, 0, NULL, 0 },
+};
 
-#define GROUP_SEPARATOR '\x1D'  /* ASCII Group Separator */
+/* Follow mode poll period, milliseconds */
+#define POLL_PERIOD_DEFAULT 1000
 
-/* The function IDs implemented in this TA */
-enum ta_smc_cmds {
-	BL31_RUNTIME_LOG_GET_SIZE,
-	OPTEE_RUNTIME_LOG_GET_SIZE,
-	RUNTIME_LOG_CMD_GET
+/* Output of the entries of follow mode */
+struct print_ctx {
+	FILE *out;
+	bool tag;               /* Prefix each entry with the name of its log */
 };
 
-static void print_buffer(char *buffer, uint32_t size)
+/**
+ * print_all - fetch and print the whole BL31 and OP-TEE logs
+ */
+static int print_all(runtime_log_session_t *session, int fd, bool concat)
 {
-	int pos;
+	char *data[RUNTIME_LOG_COUNT];
+	uint32_t size[RUNTIME_LOG_COUNT];
+	bool ok;
+
+	if (runtime_log_get(session, data, size) != TEEC_SUCCESS)
+		return 1;
 
-	for (pos = 0; pos < size; pos++) {
-		if (buffer[pos] == GROUP_SEPARATOR)
-			printf("\n");
-		else
-			printf("%c", buffer[pos]);
+	/* On success, print out BL31 and OP-TEE logs */
+	if (concat)
+		ok = runtime_log_print(fd, data[RUNTIME_LOG_OPTEE], size[RUNTIME_LOG_OPTEE]) &&
+		     runtime_log_print(fd, data[RUNTIME_LOG_BL31], size[RUNTIME_LOG_BL31]);
+	else
+		ok = runtime_log_print_merged(fd, data, size);
+	if (!ok) {
+		warn("Unable to write the logs");
+		return 1;
 	}
+
+	return 0;
+}
+
+/**
+ * print_entry - runtime_log_emit_t printing one entry per line
+ */
+static void print_entry(void *arg, enum runtime_log_id log, uint64_t seq, const char *entry, size_t len)
+{
+	struct print_ctx *ctx = arg;
+
+	if (ctx->tag)
+		fprintf(ctx->out, "[%s] ", runtime_log_name(log));
+	fwrite(entry, 1, len, ctx->out);
+	putc('\n', ctx->out);
 }
 
-int main(void)
+/**
+ * print_new - print what was logged since a cursor, once or following the logs
+ *
+ * One reader per log keeps its buffer registered for the whole run, so a
+ * poll costs one invoke per log and moves only the new bytes. Entries are
+ * printed per log as they are polled, tagged unless concat is set.
+ */
+static int print_new(runtime_log_session_t *session, FILE *out, bool concat, const char *cursor_path,
+		     bool follow, unsigned int period)
 {
-	TEEC_Result res;
-	TEEC_Context ctx;
-	TEEC_Session sess;
-	TEEC_Operation op;
-	TEEC_UUID uuid = TA_SMC_UUID;
-	uint32_t err_origin;
-
-	TEEC_SharedMemory optee_buf;
-	uint8_t *optee_data = NULL;
-	TEEC_SharedMemory bl31_buf;
-	uint8_t *bl31_data = NULL;
-	int bl31_size = 0;
-	int optee_size = 0;
-
-	/* Initialize data structure for shared buffers */
-	memset((void *)&optee_buf, 0, sizeof(optee_buf));
-	memset((void *)&bl31_data, 0, sizeof(bl31_data));
-
-	/* Initialize a context connecting us to the TEE */
-	res = TEEC_InitializeContext(NULL, &ctx);
-	if (res != TEEC_SUCCESS)
-		errx(1, "TEEC_InitializeContext failed with code 0x%x", res);
-
-	/*
-	 * Open a session to the TA.
-	 */
-	res = TEEC_OpenSession(&ctx, &sess, &uuid, TEEC_LOGIN_PUBLIC, NULL, NULL, &err_origin);
-	if (res != TEEC_SUCCESS)
-		errx(1, "TEEC_Opensession failed with code 0x%x origin 0x%x", res, err_origin);
-
-	/* Prepare the TEEC_Operation struct */
-	memset(&op, 0, sizeof(op));
-	op.paramTypes = TEEC_PARAM_TYPES(TEEC_VALUE_OUTPUT, TEEC_NONE, TEEC_NONE, TEEC_NONE);
-
-	/* Invoke the function to get the size of the BL31 runtime log */
-	res = TEEC_InvokeCommand(&sess, BL31_RUNTIME_LOG_GET_SIZE, &op, &err_origin);
-	if (res != TEEC_SUCCESS) {
-		TEEC_FinalizeContext(&ctx);
-		TEEC_CloseSession(&sess);
-		errx(1, "TEEC_InvokeCommand failed with code 0x%x origin 0x%x", res, err_origin);
+	struct print_ctx ctx = { .out = out, .tag = !concat };
+	runtime_log_reader_t readers[RUNTIME_LOG_COUNT];
+	uint64_t seq[RUNTIME_LOG_COUNT];
+	uint64_t saved[RUNTIME_LOG_COUNT];
+	uint64_t lost[RUNTIME_LOG_COUNT] = { 0 };
+	TEEC_Result res = TEEC_SUCCESS;
+	int ready = 0;
+	int ret = 1;
+
+	if (cursor_path != NULL) {
+		if (!runtime_log_cursor_load(cursor_path, seq))
+			return 1;
+	} else {
+		memset(seq, 0, sizeof(seq));
 	}
-	bl31_size = op.params[0].value.a;
-
-	/* Prepare the TEEC_Operation struct */
-	memset(&op, 0, sizeof(op));
-	op.paramTypes = TEEC_PARAM_TYPES(TEEC_VALUE_OUTPUT, TEEC_NONE, TEEC_NONE, TEEC_NONE);
-
-	/* Invoke the function to get the size of the OP-TEE runtime log */
-	res = TEEC_InvokeCommand(&sess, OPTEE_RUNTIME_LOG_GET_SIZE, &op, &err_origin);
-	if (res != TEEC_SUCCESS) {
-		TEEC_FinalizeContext(&ctx);
-		TEEC_CloseSession(&sess);
-		errx(1, "TEEC_InvokeCommand failed with code 0x%x origin 0x%x", res, err_origin);
+	memcpy(saved, seq, sizeof(saved));
+
+	for (; ready < RUNTIME_LOG_COUNT; ready++) {
+		res = runtime_log_reader_init(&readers[ready], session, ready, seq[ready]);
+		if (res != TEEC_SUCCESS)
+			goto end;
 	}
 
-	optee_size = op.params[0].value.a;
+	do {
+		/* OP-TEE first, as without options */
+		for (int i = RUNTIME_LOG_COUNT - 1; i >= 0; i--) {
+			res = runtime_log_reader_poll(&readers[i], session, print_entry, &ctx);
+			if (runtime_log_unknown_cmd(res))
+				warnx("the TA has no read cursors, only the whole logs can be printed");
+			if (res != TEEC_SUCCESS)
+				goto end;
+			if (readers[i].lost != lost[i]) {
+				warnx("%llu bytes of the %s log were overwritten before they were read",
+				      (unsigned long long)(readers[i].lost - lost[i]), runtime_log_name(i));
+				lost[i] = readers[i].lost;
+			}
+			seq[i] = readers[i].seq;
+		}
+		if (fflush(out) != 0) {
+			warn("Unable to write the logs");
+			goto end;
+		}
+
+		if (cursor_path != NULL && memcmp(seq, saved, sizeof(seq)) != 0) {
+			if (!runtime_log_cursor_save(cursor_path, seq))
+				goto end;
+			memcpy(saved, seq, sizeof(saved));
+		}
+
+		if (follow)
+			usleep(period * 1000);
+	} while (follow);
 
-	/* Create OP-TEE buffer to share with OP-TEE TA */
-	optee_data = malloc(optee_size);
-	if (optee_data == NULL) {
-		TEEC_FinalizeContext(&ctx);
-		TEEC_CloseSession(&sess);
-		return TEEC_ERROR_GENERIC;
+	ret = 0;
+
+end:
+	while (ready > 0)
+		runtime_log_reader_free(&readers[--ready]);
+
+	return ret;
+}
+
+/**
+ * parse_time_arg - seconds since the epoch, or -seconds before now, in ns
+ */
+static uint64_t parse_time_arg(const char *arg)
+{
+	unsigned long long sec;
+	char *end;
+
+	sec = strtoull(arg + (arg[0] == '-'), &end, 10);
+	if (end == arg + (arg[0] == '-') || *end != '\0' || sec > UINT64_MAX / 1000000000)
+		errx(1, "Invalid time '%s'", arg);
+	if (arg[0] == '-') {
+		time_t now = time(NULL);
+
+		sec = ((unsigned long long)now > sec) ? now - sec : 0;
 	}
 
-	/* Register shared memory for OP-TEE buffer */
-	optee_buf.buffer = optee_data;
-	optee_buf.size = optee_size;
-	optee_buf.flags = TEEC_MEM_OUTPUT;
-
-	res = TEEC_RegisterSharedMemory(&ctx, &optee_buf);
-	if (res != TEEC_SUCCESS) {
-		printf("TEEC_RegisterSharedMemory failed with code 0x%x\n", res);
-		free(optee_data);
-		TEEC_CloseSession(&sess);
-		TEEC_FinalizeContext(&ctx);
-		return res;
+	return sec * 1000000000ULL;
+}
+
+static enum runtime_log_level parse_level(const char *arg)
+{
+	for (int level = 0; level < RUNTIME_LOG_LEVEL_COUNT; level++) {
+		if (strcmp(arg, runtime_log_level_name(level)) == 0)
+			return level;
 	}
+	errx(1, "Invalid level '%s'", arg);
+}
+
+int main(int argc, char *argv[])
+{
+	runtime_log_session_t session;
+	const char *cursor_path = NULL;
+	const char *out_path = NULL;
+	FILE *out = stdout;
+	unsigned int period = POLL_PERIOD_DEFAULT;
+	bool follow = false;
+	bool concat = false;
+	const char *archive_dir = NULL;
+	const char *query_dir = NULL;
+	unsigned long segment_kib = ARCHIVE_SEGMENT_SIZE_DEFAULT / 1024;
+	unsigned long segments = ARCHIVE_SEGMENTS_DEFAULT;
+	uint64_t since = 0;
+	uint64_t until = UINT64_MAX;
+	enum runtime_log_level level = RUNTIME_LOG_LEVEL_DEBUG;
+	char *end;
+	int opt;
+	int ret;
 
-	/* Create BL31 buffer to share with OP-TEE TA */
-	bl31_data = malloc(bl31_size);
-	if (bl31_data == NULL) {
-		TEEC_FinalizeContext(&ctx);
-		TEEC_CloseSession(&sess);
-		return TEEC_ERROR_GENERIC;
+	while ((opt = getopt_long(argc, argv, "Cc:fo:p:a:n:s:q:", long_options, NULL)) != -1) {
+		switch (opt) {
+		case 'a':
+			archive_dir = optarg;
+			break;
+		case 'n':
+			segments = strtoul(optarg, &end, 0);
+			if (*end != '\0' || segments == 0 || segments > UINT32_MAX)
+				errx(1, "Invalid number of segments '%s'", optarg);
+			break;
+		case 's':
+			segment_kib = strtoul(optarg, &end, 0);
+			if (*end != '\0' || segment_kib == 0 || segment_kib > UINT32_MAX / 1024)
+				errx(1, "Invalid segment size '%s'", optarg);
+			break;
+		case 'q':
+			query_dir = optarg;
+			break;
+		case OPT_SINCE:
+			since = parse_time_arg(optarg);
+			break;
+		case OPT_UNTIL:
+			until = parse_time_arg(optarg);
+			break;
+		case OPT_LEVEL:
+			level = parse_level(optarg);
+			break;
+		case 'C':
+			concat = true;
+			break;
+		case 'c':
+			cursor_path = optarg;
+			break;
+		case 'f':
+			follow = true;
+			break;
+		case 'o':
+			out_path = optarg;
+			break;
+		case 'p':
+			period = strtoul(optarg, &end, 0);
+			if (*end != '\0' || period == 0)
+				errx(1, "Invalid poll period '%s'", optarg);
+			break;
+		default:
+			printf(HELP, argv[0]);
+			return 1;
+		}
 	}
+	if (optind != argc) {
+		printf(HELP, argv[0]);
+		return 1;
+	}
+	if (archive_dir != NULL && (query_dir != NULL || follow || cursor_path != NULL || out_path != NULL))
+		errx(1, "-a collects on its own, without -q, -f, -c or -o");
+	if (query_dir != NULL && (follow || cursor_path != NULL))
+		errx(1, "-q reads the archive, without -f or -c");
+
+	if (out_path != NULL) {
+		int fd = open(out_path, O_WRONLY | O_CREAT | O_APPEND, 0640);
 
-	/* Register shared memory for BL31 buffer */
-	bl31_buf.buffer = bl31_data;
-	bl31_buf.size = bl31_size;
-	bl31_buf.flags = TEEC_MEM_OUTPUT;
-
-	res = TEEC_RegisterSharedMemory(&ctx, &bl31_buf);
-	if (res != TEEC_SUCCESS) {
-		printf("TEEC_RegisterSharedMemory failed with code 0x%x\n", res);
-		free(bl31_data);
-		free(optee_data);
-		TEEC_ReleaseSharedMemory(&optee_buf);
-		TEEC_CloseSession(&sess);
-		TEEC_FinalizeContext(&ctx);
-		return res;
+		if (fd < 0)
+			err(1, "Unable to open %s", out_path);
+		out = fdopen(fd, "a");
+		if (out == NULL)
+			err(1, "Unable to open %s", out_path);
 	}
 
-	/* Prepare the TEEC_Operation struct and params */
-	memset(&op, 0, sizeof(op));
-	op.paramTypes = TEEC_PARAM_TYPES(TEEC_MEMREF_WHOLE, TEEC_MEMREF_WHOLE, TEEC_NONE, TEEC_NONE);
-	op.params[OP_PARAM_OPTEE_BUFFER].memref.parent = &optee_buf;
-	op.params[OP_PARAM_OPTEE_BUFFER].memref.size = optee_size;
-	op.params[OP_PARAM_BL31_BUFFER].memref.parent = &bl31_buf;
-	op.params[OP_PARAM_BL31_BUFFER].memref.size = bl31_size;
-
-	/* Invoke the function to get the BL31 and OP-TEE runtime logs */
-	res = TEEC_InvokeCommand(&sess, RUNTIME_LOG_CMD_GET, &op, &err_origin);
-	if (res != TEEC_SUCCESS) {
-		errx(1, "TEEC_InvokeCommand failed with code 0x%x origin 0x%x", res, err_origin);
-	} else {
-		/* On success, print out BL31 and OP-TEE logs */
-		if (strlen(optee_data) != 0)
-			print_buffer(optee_data, optee_size);
-		if (strlen(bl31_data) != 0)
-			print_buffer(bl31_data, bl31_size);
+	/* The archive is read without the TA */
+	if (query_dir != NULL) {
+		fflush(out);
+		ret = archive_query(query_dir, since, until, level, fileno(out)) ? 0 : 1;
+		if (out != stdout)
+			fclose(out);
+		return ret;
 	}
 
-	/* Free buffers, release shared memory, close the session, and destroy the context */
-	free(optee_data);
-	free(bl31_data);
-	TEEC_ReleaseSharedMemory(&optee_buf);
-	TEEC_ReleaseSharedMemory(&bl31_buf);
-	TEEC_CloseSession(&sess);
-	TEEC_FinalizeContext(&ctx);
+	if (runtime_log_open(&session) != TEEC_SUCCESS)
+		return 1;
 
-	return 0;
+	if (archive_dir != NULL)
+		ret = runtime_log_collect(&session, archive_dir, period, segment_kib * 1024, segments);
+	else if (follow || cursor_path != NULL)
+		ret = print_new(&session, out, concat, cursor_path, follow, period);
+	else
+		ret = print_all(&session, fileno(out), concat);
+
+	/* Close the session, and destroy the context */
+	runtime_log_close(&session);
+
+	if (out != stdout && fclose(out) != 0) {
+		warn("Unable to write %s", out_path);
+		ret = 1;
+	}
+
+	return ret;
 }
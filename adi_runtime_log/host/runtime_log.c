@@ -0,0 +1,802 @@
+/*
+ * Copyright (c) 2026, Analog Devices Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/uio.h>
+
+#include "runtime_log.h"
+
+/*
+ * This UUID is generated with uuidgen
+ * the ITU-T UUID generator at http://www.itu.int/ITU-T/asn1/uuid.html
+ */
+#define TA_SMC_UUID \
+	{ \
+		0x6dc55088, \
+		0x4255, 0x41cc, \
+		{ \
+			0x9b, 0x49, \
+			0x04, 0x53, \
+			0x4e, 0x6a, \
+			0xc3, 0xa6, \
+		} \
+	}
+
+/* The function IDs implemented in this TA */
+enum ta_smc_cmds {
+	BL31_RUNTIME_LOG_GET_SIZE,
+	OPTEE_RUNTIME_LOG_GET_SIZE,
+	RUNTIME_LOG_CMD_GET,
+	RUNTIME_LOG_CMD_READ
+};
+
+/* runtime_log_get */
+#define OP_PARAM_OPTEE_BUFFER 0
+#define OP_PARAM_BL31_BUFFER 1
+
+/* runtime_log_read */
+#define OP_PARAM_READ_LOG 0
+#define OP_PARAM_READ_SEQ 1
+#define OP_PARAM_READ_BUFFER 2
+#define OP_PARAM_READ_LOST 3
+
+/**
+ * runtime_log_name - short name of a log, as used in cursor files
+ */
+const char *runtime_log_name(enum runtime_log_id log)
+{
+	return (log == RUNTIME_LOG_BL31) ? "bl31" : "optee";
+}
+
+/**
+ * runtime_log_unknown_cmd - Whether an invoke failed because the TA lacks the command
+ *
+ * The TA dispatcher answers an unknown command ID with BAD_PARAMETERS, other
+ * TAs with NOT_SUPPORTED or NOT_IMPLEMENTED.
+ */
+bool runtime_log_unknown_cmd(TEEC_Result res)
+{
+	return res == TEEC_ERROR_NOT_SUPPORTED || res == TEEC_ERROR_BAD_PARAMETERS ||
+	       res == TEEC_ERROR_NOT_IMPLEMENTED;
+}
+
+/**
+ * runtime_log_open - Initialize a TEE context and open a session to the runtime log TA
+ */
+TEEC_Result runtime_log_open(runtime_log_session_t *session)
+{
+	TEEC_Result res;
+	TEEC_UUID uuid = TA_SMC_UUID;
+	uint32_t err_origin;
+
+	memset(session->pool, 0, sizeof(session->pool));
+
+	/* Initialize a context connecting us to the TEE */
+	res = TEEC_InitializeContext(NULL, &session->ctx);
+	if (res != TEEC_SUCCESS) {
+		printf("TEEC_InitializeContext failed with code 0x%x\n", res);
+		return res;
+	}
+
+	/* Open a session to the TA. */
+	res = TEEC_OpenSession(&session->ctx, &session->sess, &uuid, TEEC_LOGIN_PUBLIC, NULL, NULL, &err_origin);
+	if (res != TEEC_SUCCESS) {
+		printf("TEEC_Opensession failed with code 0x%x origin 0x%x\n", res, err_origin);
+		TEEC_FinalizeContext(&session->ctx);
+		return res;
+	}
+
+	return TEEC_SUCCESS;
+}
+
+/**
+ * runtime_log_close - Close the session and destroy the context
+ */
+void runtime_log_close(runtime_log_session_t *session)
+{
+	for (int i = 0; i < RUNTIME_LOG_COUNT; i++) {
+		if (session->pool[i].buffer != NULL)
+			TEEC_ReleaseSharedMemory(&session->pool[i]);
+	}
+	TEEC_CloseSession(&session->sess);
+	TEEC_FinalizeContext(&session->ctx);
+}
+
+/**
+ * runtime_log_get_size - Get the size of the buffer holding a log
+ */
+TEEC_Result runtime_log_get_size(runtime_log_session_t *session, enum runtime_log_id log, uint32_t *size)
+{
+	TEEC_Result res;
+	TEEC_Operation op;
+	uint32_t err_origin;
+
+	/* Prepare the TEEC_Operation struct */
+	memset(&op, 0, sizeof(op));
+	op.paramTypes = TEEC_PARAM_TYPES(TEEC_VALUE_OUTPUT, TEEC_NONE, TEEC_NONE, TEEC_NONE);
+
+	/* Invoke the function to get the size of the runtime log */
+	res = TEEC_InvokeCommand(&session->sess,
+				 (log == RUNTIME_LOG_BL31) ? BL31_RUNTIME_LOG_GET_SIZE : OPTEE_RUNTIME_LOG_GET_SIZE, &op,
+				 &err_origin);
+	if (res != TEEC_SUCCESS)
+		printf("TEEC_InvokeCommand failed with code 0x%x origin 0x%x\n", res, err_origin);
+	else
+		*size = op.params[0].value.a;
+
+	return res;
+}
+
+/**
+ * pool_reserve - Make the pooled buffer of a log hold at least size bytes
+ */
+static TEEC_Result pool_reserve(runtime_log_session_t *session, enum runtime_log_id log, size_t size)
+{
+	TEEC_SharedMemory *shm = &session->pool[log];
+	TEEC_Result res;
+
+	if (shm->buffer != NULL && shm->size >= size)
+		return TEEC_SUCCESS;
+
+	if (shm->buffer != NULL)
+		TEEC_ReleaseSharedMemory(shm);
+	memset(shm, 0, sizeof(*shm));
+	shm->size = (size > RUNTIME_LOG_POOL_SIZE) ? size : RUNTIME_LOG_POOL_SIZE;
+	shm->flags = TEEC_MEM_OUTPUT;
+
+	res = TEEC_AllocateSharedMemory(&session->ctx, shm);
+	if (res != TEEC_SUCCESS) {
+		printf("TEEC_AllocateSharedMemory failed with code 0x%x\n", res);
+		memset(shm, 0, sizeof(*shm));
+	}
+
+	return res;
+}
+
+/**
+ * runtime_log_get - Fetch the whole OP-TEE and BL31 logs
+ *
+ * The logs are read straight into the session's pooled buffers, so the common
+ * case is a single invoke. A TA whose log does not fit answers
+ * TEEC_ERROR_SHORT_BUFFER with the sizes it needs in the memrefs; the buffers
+ * are grown and the fetch retried. An older TA that rejects a buffer not
+ * exactly the size of its log is asked for the sizes first, as before.
+ *
+ * data[] and size[] are indexed by enum runtime_log_id. data[] points into the
+ * pool and stays valid until the next fetch or until the session is closed.
+ * Trailing NUL padding is not counted in size[]. The caller may modify the
+ * buffers, e.g. to format them in place.
+ */
+TEEC_Result runtime_log_get(runtime_log_session_t *session, char *data[RUNTIME_LOG_COUNT],
+			    uint32_t size[RUNTIME_LOG_COUNT])
+{
+	static const int param[RUNTIME_LOG_COUNT] = {
+		[RUNTIME_LOG_BL31] = OP_PARAM_BL31_BUFFER,
+		[RUNTIME_LOG_OPTEE] = OP_PARAM_OPTEE_BUFFER,
+	};
+	TEEC_Result res;
+	TEEC_Operation op;
+	uint32_t err_origin;
+	size_t want[RUNTIME_LOG_COUNT] = { 0 };
+	bool exact = false;
+
+	for (int attempt = 0; attempt < 3; attempt++) {
+		/* Prepare the TEEC_Operation struct and params */
+		memset(&op, 0, sizeof(op));
+		op.paramTypes = TEEC_PARAM_TYPES(TEEC_MEMREF_WHOLE, TEEC_MEMREF_WHOLE, TEEC_NONE, TEEC_NONE);
+		for (int i = 0; i < RUNTIME_LOG_COUNT; i++) {
+			res = pool_reserve(session, i, want[i]);
+			if (res != TEEC_SUCCESS)
+				return res;
+			op.params[param[i]].memref.parent = &session->pool[i];
+			op.params[param[i]].memref.size = exact ? want[i] : session->pool[i].size;
+			/* A TA that does not report the length written leaves zeros after the log */
+			memset(session->pool[i].buffer, 0, op.params[param[i]].memref.size);
+		}
+
+		/* Invoke the function to get the BL31 and OP-TEE runtime logs */
+		res = TEEC_InvokeCommand(&session->sess, RUNTIME_LOG_CMD_GET, &op, &err_origin);
+		if (res == TEEC_SUCCESS) {
+			for (int i = 0; i < RUNTIME_LOG_COUNT; i++) {
+				data[i] = session->pool[i].buffer;
+				size[i] = op.params[param[i]].memref.size;
+				while (size[i] > 0 && data[i][size[i] - 1] == '\0')
+					size[i]--;
+			}
+			return TEEC_SUCCESS;
+		}
+
+		if (res == TEEC_ERROR_SHORT_BUFFER && !exact) {
+			for (int i = 0; i < RUNTIME_LOG_COUNT; i++)
+				want[i] = op.params[param[i]].memref.size;
+		} else if (res == TEEC_ERROR_BAD_PARAMETERS && !exact) {
+			for (int i = 0; i < RUNTIME_LOG_COUNT; i++) {
+				uint32_t log_size;
+
+				res = runtime_log_get_size(session, i, &log_size);
+				if (res != TEEC_SUCCESS)
+					return res;
+				want[i] = log_size;
+			}
+			exact = true;
+		} else {
+			break;
+		}
+	}
+
+	printf("TEEC_InvokeCommand failed with code 0x%x origin 0x%x\n", res, err_origin);
+
+	return res;
+}
+
+/**
+ * write_iov - writev all of iov, resuming after partial writes
+ */
+static bool write_iov(int fd, struct iovec *iov, int cnt)
+{
+	ssize_t n;
+
+	while (cnt > 0) {
+		n = writev(fd, iov, cnt);
+		if (n < 0) {
+			if (errno == EINTR)
+				continue;
+			return false;
+		}
+		while (cnt > 0 && (size_t)n >= iov->iov_len) {
+			n -= iov->iov_len;
+			iov++;
+			cnt--;
+		}
+		if (cnt > 0) {
+			iov->iov_base = (char *)iov->iov_base + n;
+			iov->iov_len -= n;
+		}
+	}
+
+	return true;
+}
+
+/**
+ * runtime_log_print - Write a log buffer to fd, one entry per line
+ *
+ * The buffer is formatted in place: separators are found with memchr and
+ * turned into newlines, and the text between NUL bytes (padding and unused
+ * parts of the buffer) goes out in writev batches of RUNTIME_LOG_PRINT_IOV.
+ */
+bool runtime_log_print(int fd, char *buf, size_t len)
+{
+	struct iovec iov[RUNTIME_LOG_PRINT_IOV];
+	char *end = buf + len;
+	char *p, *q;
+	int cnt = 0;
+
+	for (p = buf; (q = memchr(p, GROUP_SEPARATOR, end - p)) != NULL; p = q + 1)
+		*q = '\n';
+
+	for (p = buf; p < end; p = q + 1) {
+		q = memchr(p, '\0', end - p);
+		if (q == NULL)
+			q = end;
+		if (q > p) {
+			iov[cnt].iov_base = p;
+			iov[cnt].iov_len = q - p;
+			if (++cnt == RUNTIME_LOG_PRINT_IOV) {
+				if (!write_iov(fd, iov, cnt))
+					return false;
+				cnt = 0;
+			}
+		}
+		if (q == end)
+			break;
+	}
+
+	return write_iov(fd, iov, cnt);
+}
+
+/* Position of runtime_log_print_merged in one log */
+struct merge_cursor {
+	char *pos;              /* Start of the next entry */
+	char *end;
+	char *entry;            /* Current entry, with its separator if it has one */
+	size_t len;
+	uint64_t time;          /* Timestamp of the current entry, in ns */
+};
+
+/**
+ * parse_time - Parse the timestamp at the start of an entry
+ *
+ * Either "[  sec.frac]" as printed by the kernel, or a bare "sec.frac"
+ * followed by a space or a colon. Digits past nanoseconds are ignored.
+ * Returns the end of the timestamp, or NULL if the entry has none.
+ */
+static const char *parse_time(const char *p, const char *end, uint64_t *ns)
+{
+	bool bracket = false;
+	uint64_t sec = 0;
+	uint64_t frac = 0;
+	int digits = 0;
+	int scale = 0;
+
+	while (p < end && *p == ' ')
+		p++;
+	if (p < end && *p == '[') {
+		bracket = true;
+		for (p++; p < end && *p == ' '; p++)
+			;
+	}
+	for (; p < end && *p >= '0' && *p <= '9'; p++, digits++)
+		sec = sec * 10 + (*p - '0');
+	if (digits == 0 || digits > 10)
+		return NULL;
+
+	if (p < end && *p == '.') {
+		for (p++; p < end && *p >= '0' && *p <= '9'; p++) {
+			if (scale < 9) {
+				frac = frac * 10 + (*p - '0');
+				scale++;
+			}
+		}
+		if (scale == 0)
+			return NULL;
+	} else if (!bracket) {
+		/* A bare integer is more likely part of the message */
+		return NULL;
+	}
+	for (; scale < 9; scale++)
+		frac *= 10;
+
+	if (bracket) {
+		if (p >= end || *p != ']')
+			return NULL;
+		p++;
+	} else if (p >= end || (*p != ' ' && *p != ':')) {
+		return NULL;
+	}
+
+	*ns = sec * 1000000000ULL + frac;
+
+	return p;
+}
+
+/**
+ * runtime_log_entry_time - Timestamp of an entry in ns, if it starts with one
+ */
+bool runtime_log_entry_time(const char *entry, size_t len, uint64_t *ns)
+{
+	return parse_time(entry, entry + len, ns) != NULL;
+}
+
+/**
+ * runtime_log_entry_level - Severity of an entry, from its TF-A or OP-TEE prefix
+ *
+ * The prefix follows the timestamp if there is one: "ERROR:", "WARNING:",
+ * "NOTICE:", "INFO:" or "VERBOSE:" from TF-A, "E/", "W/", "I/", "D/" or "F/"
+ * from OP-TEE. Entries without one are counted as info.
+ */
+enum runtime_log_level runtime_log_entry_level(const char *entry, size_t len)
+{
+	static const struct {
+		const char *prefix;
+		enum runtime_log_level level;
+	} prefixes[] = {
+		{ "ERROR:", RUNTIME_LOG_LEVEL_ERROR },
+		{ "WARNING:", RUNTIME_LOG_LEVEL_WARNING },
+		{ "NOTICE:", RUNTIME_LOG_LEVEL_INFO },
+		{ "INFO:", RUNTIME_LOG_LEVEL_INFO },
+		{ "VERBOSE:", RUNTIME_LOG_LEVEL_DEBUG },
+		{ "E/", RUNTIME_LOG_LEVEL_ERROR },
+		{ "W/", RUNTIME_LOG_LEVEL_WARNING },
+		{ "I/", RUNTIME_LOG_LEVEL_INFO },
+		{ "D/", RUNTIME_LOG_LEVEL_DEBUG },
+		{ "F/", RUNTIME_LOG_LEVEL_DEBUG },
+	};
+	const char *end = entry + len;
+	const char *p;
+	uint64_t ns;
+
+	p = parse_time(entry, end, &ns);
+	if (p == NULL)
+		p = entry;
+	while (p < end && *p == ' ')
+		p++;
+
+	for (size_t i = 0; i < sizeof(prefixes) / sizeof(prefixes[0]); i++) {
+		size_t n = strlen(prefixes[i].prefix);
+
+		if ((size_t)(end - p) >= n && memcmp(p, prefixes[i].prefix, n) == 0)
+			return prefixes[i].level;
+	}
+
+	return RUNTIME_LOG_LEVEL_INFO;
+}
+
+/**
+ * runtime_log_level_name - Name of a level, as taken by --level
+ */
+const char *runtime_log_level_name(enum runtime_log_level level)
+{
+	static const char *const names[RUNTIME_LOG_LEVEL_COUNT] = {
+		[RUNTIME_LOG_LEVEL_ERROR] = "error",
+		[RUNTIME_LOG_LEVEL_WARNING] = "warning",
+		[RUNTIME_LOG_LEVEL_INFO] = "info",
+		[RUNTIME_LOG_LEVEL_DEBUG] = "debug",
+	};
+
+	return names[level];
+}
+
+/**
+ * merge_next - Move a cursor to the next non-empty entry
+ *
+ * NUL bytes between entries are skipped. An entry without a timestamp keeps
+ * the time of the one before it, so continuation lines stay in place.
+ */
+static bool merge_next(struct merge_cursor *cur)
+{
+	char *p = cur->pos;
+	char *q;
+
+	for (;;) {
+		while (p < cur->end && (*p == '\0' || *p == GROUP_SEPARATOR))
+			p++;
+		if (p == cur->end) {
+			cur->pos = p;
+			cur->entry = NULL;
+			return false;
+		}
+
+		q = p;
+		while (q < cur->end && *q != '\0' && *q != GROUP_SEPARATOR)
+			q++;
+		if (q > p)
+			break;
+		p = q;
+	}
+
+	parse_time(p, q, &cur->time);
+	cur->entry = p;
+	if (q < cur->end && *q == GROUP_SEPARATOR) {
+		*q++ = '\n';
+		cur->len = q - p;
+	} else {
+		cur->len = q - p;
+	}
+	cur->pos = q;
+
+	return true;
+}
+
+/**
+ * runtime_log_print_merged - Write the logs to fd as one time-ordered stream
+ *
+ * data[] and size[] are as returned by runtime_log_get. Each log is already
+ * in time order, so the entries are merged by taking the earliest head at
+ * every step; on a tie the log with the lower id goes first. Every line is
+ * tagged with the name of its log.
+ *
+ * The buffers are not copied: separators are turned into newlines in place
+ * and the tags and entries go out in writev batches.
+ */
+bool runtime_log_print_merged(int fd, char *data[RUNTIME_LOG_COUNT], const uint32_t size[RUNTIME_LOG_COUNT])
+{
+	static const struct iovec tag[RUNTIME_LOG_COUNT] = {
+		[RUNTIME_LOG_BL31] = { .iov_base = "[bl31] ", .iov_len = 7 },
+		[RUNTIME_LOG_OPTEE] = { .iov_base = "[optee] ", .iov_len = 8 },
+	};
+	static char newline = '\n';
+	struct merge_cursor cur[RUNTIME_LOG_COUNT];
+	struct iovec iov[RUNTIME_LOG_PRINT_IOV];
+	int cnt = 0;
+
+	for (int i = 0; i < RUNTIME_LOG_COUNT; i++) {
+		cur[i].pos = data[i];
+		cur[i].end = data[i] + size[i];
+		cur[i].time = 0;
+		merge_next(&cur[i]);
+	}
+
+	for (;;) {
+		int next = -1;
+
+		for (int i = 0; i < RUNTIME_LOG_COUNT; i++) {
+			if (cur[i].entry != NULL && (next < 0 || cur[i].time < cur[next].time))
+				next = i;
+		}
+		if (next < 0)
+			break;
+
+		if (cnt + 3 > RUNTIME_LOG_PRINT_IOV) {
+			if (!write_iov(fd, iov, cnt))
+				return false;
+			cnt = 0;
+		}
+		iov[cnt++] = tag[next];
+		iov[cnt].iov_base = cur[next].entry;
+		iov[cnt++].iov_len = cur[next].len;
+		if (cur[next].entry[cur[next].len - 1] != '\n') {
+			iov[cnt].iov_base = &newline;
+			iov[cnt++].iov_len = 1;
+		}
+
+		merge_next(&cur[next]);
+	}
+
+	return write_iov(fd, iov, cnt);
+}
+
+/**
+ * runtime_log_read - Read the bytes of a log written since sequence number *seq
+ *
+ * Up to shm->size bytes starting at *seq are copied to shm; *len is the number
+ * copied and *seq is advanced past them. If the log has already overwritten
+ * bytes from *seq on, the TA starts at the oldest byte it still has and *lost
+ * is the number skipped. A sequence number past the end of the log, e.g. from
+ * before a reboot, also reads from the oldest byte.
+ */
+TEEC_Result runtime_log_read(runtime_log_session_t *session, TEEC_SharedMemory *shm, enum runtime_log_id log,
+			     uint64_t *seq, uint32_t *len, uint64_t *lost)
+{
+	TEEC_Result res;
+	TEEC_Operation op;
+	uint32_t err_origin;
+
+	/* Prepare the TEEC_Operation struct */
+	memset(&op, 0, sizeof(op));
+	op.paramTypes = TEEC_PARAM_TYPES(TEEC_VALUE_INPUT, TEEC_VALUE_INOUT, TEEC_MEMREF_WHOLE, TEEC_VALUE_OUTPUT);
+	op.params[OP_PARAM_READ_LOG].value.a = log;
+	op.params[OP_PARAM_READ_SEQ].value.a = (uint32_t)*seq;
+	op.params[OP_PARAM_READ_SEQ].value.b = (uint32_t)(*seq >> 32);
+	op.params[OP_PARAM_READ_BUFFER].memref.parent = shm;
+	op.params[OP_PARAM_READ_BUFFER].memref.size = shm->size;
+
+	/* Invoke the function */
+	res = TEEC_InvokeCommand(&session->sess, RUNTIME_LOG_CMD_READ, &op, &err_origin);
+	if (res != TEEC_SUCCESS) {
+		/* An older TA without read cursors is handled by the caller */
+		if (!runtime_log_unknown_cmd(res))
+			printf("TEEC_InvokeCommand failed with code 0x%x origin 0x%x\n", res, err_origin);
+		return res;
+	}
+
+	*len = op.params[OP_PARAM_READ_BUFFER].memref.size;
+	*seq = ((uint64_t)op.params[OP_PARAM_READ_SEQ].value.b << 32) | op.params[OP_PARAM_READ_SEQ].value.a;
+	*lost = ((uint64_t)op.params[OP_PARAM_READ_LOST].value.b << 32) | op.params[OP_PARAM_READ_LOST].value.a;
+
+	return TEEC_SUCCESS;
+}
+
+/**
+ * runtime_log_reader_init - Start reading a log from sequence number seq
+ *
+ * The buffer is the size of the whole log, so one read catches up however
+ * far behind the reader is.
+ */
+TEEC_Result runtime_log_reader_init(runtime_log_reader_t *reader, runtime_log_session_t *session,
+				    enum runtime_log_id log, uint64_t seq)
+{
+	TEEC_Result res;
+	uint32_t size = 0;
+
+	memset(reader, 0, sizeof(*reader));
+	reader->log = log;
+	reader->seq = seq;
+
+	res = runtime_log_get_size(session, log, &size);
+	if (res != TEEC_SUCCESS)
+		return res;
+
+	reader->shm.buffer = malloc(size ? size : 1);
+	if (reader->shm.buffer == NULL)
+		return TEEC_ERROR_OUT_OF_MEMORY;
+	reader->shm.size = size ? size : 1;
+	reader->shm.flags = TEEC_MEM_OUTPUT;
+
+	res = TEEC_RegisterSharedMemory(&session->ctx, &reader->shm);
+	if (res != TEEC_SUCCESS) {
+		printf("TEEC_RegisterSharedMemory failed with code 0x%x\n", res);
+		free(reader->shm.buffer);
+		reader->shm.buffer = NULL;
+	}
+
+	return res;
+}
+
+/**
+ * runtime_log_reader_free - Release the buffer of a reader
+ */
+void runtime_log_reader_free(runtime_log_reader_t *reader)
+{
+	if (reader->shm.buffer == NULL)
+		return;
+	TEEC_ReleaseSharedMemory(&reader->shm);
+	free(reader->shm.buffer);
+	reader->shm.buffer = NULL;
+}
+
+/**
+ * keep_partial - hold back bytes of an entry until its separator arrives
+ *
+ * An entry longer than RUNTIME_LOG_ENTRY_MAX is passed on in pieces.
+ */
+static void keep_partial(runtime_log_reader_t *reader, const char *data, size_t len, uint64_t seq,
+			 runtime_log_emit_t emit, void *arg)
+{
+	size_t n;
+
+	while (len > 0) {
+		n = RUNTIME_LOG_ENTRY_MAX - reader->partial_len;
+		if (n > len)
+			n = len;
+		memcpy(reader->partial + reader->partial_len, data, n);
+		reader->partial_len += n;
+		data += n;
+		len -= n;
+		seq += n;
+		if (reader->partial_len == RUNTIME_LOG_ENTRY_MAX) {
+			emit(arg, reader->log, seq, reader->partial, reader->partial_len);
+			reader->partial_len = 0;
+		}
+	}
+}
+
+/**
+ * split_entries - pass every complete entry of a read on to emit
+ *
+ * seq is the sequence number of the first byte of data.
+ */
+static void split_entries(runtime_log_reader_t *reader, const char *data, size_t len, uint64_t seq,
+			  runtime_log_emit_t emit, void *arg)
+{
+	const char *start = data;
+	const char *end = data + len;
+	const char *sep;
+
+	if (reader->resync) {
+		sep = memchr(data, GROUP_SEPARATOR, len);
+		if (sep == NULL)
+			return;
+		data = sep + 1;
+		reader->resync = false;
+	}
+
+	while ((sep = memchr(data, GROUP_SEPARATOR, end - data)) != NULL) {
+		if (reader->partial_len > 0) {
+			keep_partial(reader, data, sep - data, seq + (data - start), emit, arg);
+			/* Empty if keep_partial just flushed a full entry */
+			if (reader->partial_len > 0)
+				emit(arg, reader->log, seq + (sep + 1 - start), reader->partial, reader->partial_len);
+			reader->partial_len = 0;
+		} else {
+			emit(arg, reader->log, seq + (sep + 1 - start), data, sep - data);
+		}
+		data = sep + 1;
+	}
+	keep_partial(reader, data, end - data, seq + (data - start), emit, arg);
+}
+
+/**
+ * runtime_log_reader_poll - Read what was written to the log since the last poll
+ *
+ * Every entry completed by the new bytes is passed to emit, in order, with the
+ * sequence number just past its separator. Bytes of
+ * an entry still being written are kept for the next poll. A log written as
+ * fast as it is read is left for the next poll after RUNTIME_LOG_POLL_READS
+ * full buffers.
+ */
+TEEC_Result runtime_log_reader_poll(runtime_log_reader_t *reader, runtime_log_session_t *session,
+				    runtime_log_emit_t emit, void *arg)
+{
+	TEEC_Result res;
+	uint64_t lost;
+	uint32_t len;
+	int reads = 0;
+
+	do {
+		len = reader->shm.size;
+		res = runtime_log_read(session, &reader->shm, reader->log, &reader->seq, &len, &lost);
+		if (res != TEEC_SUCCESS)
+			return res;
+
+		/* The read starts inside an entry whose start is gone */
+		if (lost > 0) {
+			reader->lost += lost;
+			reader->partial_len = 0;
+			reader->resync = true;
+		}
+		split_entries(reader, reader->shm.buffer, len, reader->seq - len, emit, arg);
+	} while (len == reader->shm.size && ++reads < RUNTIME_LOG_POLL_READS);
+
+	return TEEC_SUCCESS;
+}
+
+/**
+ * runtime_log_cursor_load - read the sequence numbers saved by a previous run
+ *
+ * A missing file starts every log from its oldest byte.
+ */
+bool runtime_log_cursor_load(const char *path, uint64_t seq[RUNTIME_LOG_COUNT])
+{
+	char name[16];
+	unsigned long long value;
+	FILE *fp;
+	bool ok = true;
+
+	memset(seq, 0, RUNTIME_LOG_COUNT * sizeof(uint64_t));
+
+	fp = fopen(path, "r");
+	if (fp == NULL)
+		return errno == ENOENT;
+
+	while (ok && fscanf(fp, "%15s %llu", name, &value) == 2) {
+		if (strcmp(name, runtime_log_name(RUNTIME_LOG_BL31)) == 0)
+			seq[RUNTIME_LOG_BL31] = value;
+		else if (strcmp(name, runtime_log_name(RUNTIME_LOG_OPTEE)) == 0)
+			seq[RUNTIME_LOG_OPTEE] = value;
+		else
+			ok = false;
+	}
+	if (!feof(fp))
+		ok = false;
+	fclose(fp);
+
+	if (!ok)
+		printf("Invalid cursor file %s\n", path);
+
+	return ok;
+}
+
+/**
+ * runtime_log_cursor_save - save the sequence numbers to continue from next run
+ *
+ * The file is replaced in one rename, so a reader never sees it half written.
+ */
+bool runtime_log_cursor_save(const char *path, const uint64_t seq[RUNTIME_LOG_COUNT])
+{
+	char tmp[4096];
+	FILE *fp;
+	bool ok;
+
+	if (snprintf(tmp, sizeof(tmp), "%s.tmp", path) >= (int)sizeof(tmp))
+		return false;
+
+	fp = fopen(tmp, "w");
+	if (fp == NULL) {
+		printf("Unable to open file %s\n", tmp);
+		return false;
+	}
+	for (int i = 0; i < RUNTIME_LOG_COUNT; i++)
+		fprintf(fp, "%s %llu\n", runtime_log_name(i), (unsigned long long)seq[i]);
+	ok = (fclose(fp) == 0) && rename(tmp, path) == 0;
+	if (!ok)
+		printf("Unable to write cursor file %s\n", path);
+
+	return ok;
+}
@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2026, Analog Devices Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef RUNTIME_LOG_H
+#define RUNTIME_LOG_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* OP-TEE TEE client API (built by optee_client) */
+#include <tee_client_api.h>
+
+#define GROUP_SEPARATOR '\x1D'  /* ASCII Group Separator, ends every log entry */
+
+/* Logs kept by the secure world */
+enum runtime_log_id {
+	RUNTIME_LOG_BL31,
+	RUNTIME_LOG_OPTEE,
+	RUNTIME_LOG_COUNT
+};
+
+/* Severity of an entry, most severe first */
+enum runtime_log_level {
+	RUNTIME_LOG_LEVEL_ERROR,
+	RUNTIME_LOG_LEVEL_WARNING,
+	RUNTIME_LOG_LEVEL_INFO,
+	RUNTIME_LOG_LEVEL_DEBUG,
+	RUNTIME_LOG_LEVEL_COUNT
+};
+
+/* Longest entry kept back while waiting for its separator */
+#define RUNTIME_LOG_ENTRY_MAX 4096
+
+/* Most text runs per writev of runtime_log_print */
+#define RUNTIME_LOG_PRINT_IOV 64
+
+/* Most reads of one log per poll */
+#define RUNTIME_LOG_POLL_READS 4
+
+/* Smallest buffer kept in the pool for each log by runtime_log_get */
+#define RUNTIME_LOG_POOL_SIZE (64 * 1024)
+
+/*
+ * Open context and session to the runtime log TA. The pool holds one shared
+ * buffer per log, allocated by the first runtime_log_get and reused by every
+ * later one until the session is closed.
+ */
+typedef struct runtime_log_session {
+	TEEC_Context ctx;
+	TEEC_Session sess;
+	TEEC_SharedMemory pool[RUNTIME_LOG_COUNT];
+} runtime_log_session_t;
+
+/*
+ * Incremental reader of one log. The log is addressed by sequence number,
+ * the count of bytes written to it since boot, so a reader only fetches what
+ * was written since its last read. The buffer is registered once and reused
+ * by every read.
+ */
+typedef struct runtime_log_reader {
+	enum runtime_log_id log;
+	TEEC_SharedMemory shm;
+	uint64_t seq;                   /* Sequence number of the next byte to read */
+	uint64_t lost;                  /* Bytes overwritten before they could be read */
+	char partial[RUNTIME_LOG_ENTRY_MAX];
+	size_t partial_len;             /* Bytes of an entry still missing its separator */
+	bool resync;                    /* Skip to the next entry, the start of this one is lost */
+} runtime_log_reader_t;
+
+/*
+ * Consumer of complete log entries, without their separator. seq is the
+ * sequence number just past the entry.
+ */
+typedef void (*runtime_log_emit_t)(void *arg, enum runtime_log_id log, uint64_t seq, const char *entry,
+				   size_t len);
+
+const char *runtime_log_name(enum runtime_log_id log);
+const char *runtime_log_level_name(enum runtime_log_level level);
+bool runtime_log_entry_time(const char *entry, size_t len, uint64_t *ns);
+enum runtime_log_level runtime_log_entry_level(const char *entry, size_t len);
+
+bool runtime_log_unknown_cmd(TEEC_Result res);
+TEEC_Result runtime_log_open(runtime_log_session_t *session);
+void runtime_log_close(runtime_log_session_t *session);
+TEEC_Result runtime_log_get_size(runtime_log_session_t *session, enum runtime_log_id log, uint32_t *size);
+TEEC_Result runtime_log_get(runtime_log_session_t *session, char *data[RUNTIME_LOG_COUNT],
+			    uint32_t size[RUNTIME_LOG_COUNT]);
+bool runtime_log_print(int fd, char *buf, size_t len);
+bool runtime_log_print_merged(int fd, char *data[RUNTIME_LOG_COUNT], const uint32_t size[RUNTIME_LOG_COUNT]);
+TEEC_Result runtime_log_read(runtime_log_session_t *session, TEEC_SharedMemory *shm, enum runtime_log_id log,
+			     uint64_t *seq, uint32_t *len, uint64_t *lost);
+
+TEEC_Result runtime_log_reader_init(runtime_log_reader_t *reader, runtime_log_session_t *session,
+				    enum runtime_log_id log, uint64_t seq);
+void runtime_log_reader_free(runtime_log_reader_t *reader);
+TEEC_Result runtime_log_reader_poll(runtime_log_reader_t *reader, runtime_log_session_t *session,
+				    runtime_log_emit_t emit, void *arg);
+
+bool runtime_log_cursor_load(const char *path, uint64_t seq[RUNTIME_LOG_COUNT]);
+bool runtime_log_cursor_save(const char *path, const uint64_t seq[RUNTIME_LOG_COUNT]);
+
+#endif /* RUNTIME_LOG_H */
@@ -25,6 +25,8 @@
  * POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <stdio.h>
+#include <string.h>
 #include <unistd.h>
 #include "adimem.h"
 
@@ -46,62 +48,562 @@
 #define OP_PARAM_DATA 2
 #define OP_PARAM_PRIV 3
 
+/* Op parameter offsets for range commands */
+#define OP_PARAM_RANGE 0
+#define OP_PARAM_BUFFER 1
+#define OP_PARAM_RESULT 2
+
 /**
- * adi_readwrite_memory - Open a TEE session to read/write memory addresses
+ * adimem_priv - Value of the "privileged" flag passed to the adimem TA
+ *
+ * If application is running as root, flag this as a "privileged" access to the adimem TA.
+ * adimem TA will only respect this flag if all of the following are true:
+ * 1) adimem TA is part of a debug build
+ * 2) Device lifecycle state is pre-deployed
+ *
+ * Obviously an attacker could write a non-root host application that deliberately sets
+ * the privileged flag. The TA checks listed above are intended to prevent an attacker
+ * from exploiting this in a production image, or a debug image that is deployed in the field.
+ * Also, users must be part of the "tee" user group in order to call OP-TEE TAs.
+ */
+static uint32_t adimem_priv(void)
+{
+	return (geteuid() == 0) ? 1 : 0;
+}
+
+/**
+ * adimem_open_session - Initialize a TEE context and open a session to the adimem TA
  */
-TEEC_Result adi_readwrite_memory(enum ta_adimem_cmds command, uint64_t address, size_t size, uint32_t *rw_value)
+TEEC_Result adimem_open_session(adimem_session_t *session)
 {
 	TEEC_Result res;
-	TEEC_Context ctx;
-	TEEC_Session sess;
-	TEEC_Operation op;
 	TEEC_UUID uuid = TA_ADIMEM_UUID;
 	uint32_t err_origin;
 
 	/* Initialize a context connecting us to the TEE */
-	res = TEEC_InitializeContext(NULL, &ctx);
+	res = TEEC_InitializeContext(NULL, &session->ctx);
 	if (res != TEEC_SUCCESS) {
 		printf("TEEC_InitializeContext failed with code 0x%x\n", res);
 		return res;
 	}
 
 	/* Open a session to the TA. */
-	res = TEEC_OpenSession(&ctx, &sess, &uuid, TEEC_LOGIN_PUBLIC, NULL, NULL, &err_origin);
+	res = TEEC_OpenSession(&session->ctx, &session->sess, &uuid, TEEC_LOGIN_PUBLIC, NULL, NULL, &err_origin);
 	if (res != TEEC_SUCCESS) {
 		printf("TEEC_Opensession failed with code 0x%x origin 0x%x\n", res, err_origin);
-		TEEC_FinalizeContext(&ctx);
+		TEEC_FinalizeContext(&session->ctx);
+		return res;
+	}
+	session->cache = NULL;
+
+	return TEEC_SUCCESS;
+}
+
+/**
+ * adimem_close_session - Close the session and destroy the context
+ */
+void adimem_close_session(adimem_session_t *session)
+{
+	TEEC_CloseSession(&session->sess);
+	TEEC_FinalizeContext(&session->ctx);
+}
+
+/**
+ * adimem_invoke_range - Invoke a range command on an open session
+ *
+ * The parameters (an adimem_range_params_t, or a command specific struct that
+ * starts with one) are shared as an input buffer. buf (optional) is shared
+ * with the given direction flags and result carries the command specific
+ * values in and out of the TA.
+ */
+static TEEC_Result adimem_invoke_range(adimem_session_t *session, enum ta_adimem_cmds command,
+				       void *params, size_t params_size, void *buf, size_t buf_size,
+				       uint32_t buf_flags, TEEC_Value *result)
+{
+	TEEC_Result res;
+	TEEC_Operation op;
+	TEEC_SharedMemory param_buf;
+	TEEC_SharedMemory data_buf;
+	uint32_t err_origin;
+
+	/* Initialize data structure for shared buffers */
+	memset((void *)&param_buf, 0, sizeof(param_buf));
+	memset((void *)&data_buf, 0, sizeof(data_buf));
+
+	/* Register shared memory */
+	param_buf.buffer = params;
+	param_buf.size = params_size;
+	param_buf.flags = TEEC_MEM_INPUT;
+
+	res = TEEC_RegisterSharedMemory(&session->ctx, &param_buf);
+	if (res != TEEC_SUCCESS) {
+		printf("TEEC_RegisterSharedMemory failed with code 0x%x\n", res);
 		return res;
 	}
 
+	if (buf != NULL) {
+		data_buf.buffer = buf;
+		data_buf.size = buf_size;
+		data_buf.flags = buf_flags;
+
+		res = TEEC_RegisterSharedMemory(&session->ctx, &data_buf);
+		if (res != TEEC_SUCCESS) {
+			printf("TEEC_RegisterSharedMemory failed with code 0x%x\n", res);
+			TEEC_ReleaseSharedMemory(&param_buf);
+			return res;
+		}
+	}
+
+	/* Prepare the TEEC_Operation struct */
+	memset(&op, 0, sizeof(op));
+	op.paramTypes = TEEC_PARAM_TYPES(TEEC_MEMREF_WHOLE,
+					 (buf != NULL) ? TEEC_MEMREF_WHOLE : TEEC_NONE,
+					 TEEC_VALUE_INOUT, TEEC_VALUE_INPUT);
+	op.params[OP_PARAM_RANGE].memref.parent = &param_buf;
+	op.params[OP_PARAM_RANGE].memref.size = params_size;
+	if (buf != NULL) {
+		op.params[OP_PARAM_BUFFER].memref.parent = &data_buf;
+		op.params[OP_PARAM_BUFFER].memref.size = buf_size;
+	}
+	op.params[OP_PARAM_RESULT].value = *result;
+	op.params[OP_PARAM_PRIV].value.a = adimem_priv();
+
+	/* Invoke the function */
+	res = TEEC_InvokeCommand(&session->sess, command, &op, &err_origin);
+	if (res != TEEC_SUCCESS)
+		printf("tee_adimem command %d failed with code 0x%x origin 0x%x\n", command, res, err_origin);
+	else
+		*result = op.params[OP_PARAM_RESULT].value;
+
+	/* Release shared memory */
+	if (buf != NULL)
+		TEEC_ReleaseSharedMemory(&data_buf);
+	TEEC_ReleaseSharedMemory(&param_buf);
+
+	return res;
+}
+
+/**
+ * adimem_invoke_rw - Read/write one register on an open session
+ *
+ * Address and value are split across the a (low) and b (high) words of
+ * their op parameters so that 64-bit addresses and accesses reach the TA.
+ */
+static TEEC_Result adimem_invoke_rw(adimem_session_t *session, enum ta_adimem_cmds command, uint64_t address,
+				    size_t size, uint64_t *rw_value)
+{
+	TEEC_Result res;
+	TEEC_Operation op;
+	uint32_t err_origin;
+
 	/* Prepare the TEEC_Operation struct */
 	memset(&op, 0, sizeof(op));
 	op.paramTypes = TEEC_PARAM_TYPES(TEEC_VALUE_INPUT, TEEC_VALUE_INPUT, TEEC_VALUE_INOUT, TEEC_VALUE_INPUT);
-	op.params[OP_PARAM_ADDR].value.a = address;
+	op.params[OP_PARAM_ADDR].value.a = (uint32_t)address;
+	op.params[OP_PARAM_ADDR].value.b = (uint32_t)(address >> 32);
 	op.params[OP_PARAM_SIZE].value.a = size;
-	op.params[OP_PARAM_DATA].value.a = *rw_value;
-
-	/* If application is running as root, flag this as a "privileged" access to the adimem TA.
-	 * adimem TA will only respect this flag if all of the following are true:
-	 * 1) adimem TA is part of a debug build
-	 * 2) Device lifecycle state is pre-deployed
-	 *
-	 * Obviously an attacker could write a non-root host application that deliberately sets
-	 * the privileged flag. The TA checks listed above are intended to prevent an attacker
-	 * from exploiting this in a production image, or a debug image that is deployed in the field.
-	 * Also, users must be part of the "tee" user group in order to call OP-TEE TAs.
-	 */
-	op.params[OP_PARAM_PRIV].value.a = (geteuid() == 0) ? 1 : 0;
+	op.params[OP_PARAM_DATA].value.a = (uint32_t)*rw_value;
+	op.params[OP_PARAM_DATA].value.b = (uint32_t)(*rw_value >> 32);
+	op.params[OP_PARAM_PRIV].value.a = adimem_priv();
 
 	/* Invoke the function */
-	res = TEEC_InvokeCommand(&sess, command, &op, &err_origin);
+	res = TEEC_InvokeCommand(&session->sess, command, &op, &err_origin);
 	if (res != TEEC_SUCCESS)
 		printf("tee_readwrite_memory failed with code 0x%x origin 0x%x\n", res, err_origin);
 	else
-		*rw_value = op.params[OP_PARAM_DATA].value.a;
+		*rw_value = ((uint64_t)op.params[OP_PARAM_DATA].value.b << 32) |
+			    op.params[OP_PARAM_DATA].value.a;
+	adimem_record(command, address, size, *rw_value, res);
+
+	return res;
+}
+
+/**
+ * adi_readwrite_memory - Open a TEE session to read/write memory addresses
+ */
+TEEC_Result adi_readwrite_memory(enum ta_adimem_cmds command, uint64_t address, size_t size, uint64_t *rw_value)
+{
+	TEEC_Result res;
+	adimem_session_t session;
+
+	res = adimem_open_session(&session);
+	if (res != TEEC_SUCCESS)
+		return res;
+
+	res = adimem_invoke_rw(&session, command, address, size, rw_value);
+
+	adimem_close_session(&session);
+
+	return res;
+}
+
+/**
+ * adi_read_register - Read one register on an open session, through its cache
+ */
+TEEC_Result adi_read_register(adimem_session_t *session, uint64_t address, size_t size, uint64_t *value)
+{
+	TEEC_Result res;
+
+	if (session->cache != NULL && adimem_cache_lookup(session->cache, address, size, value)) {
+		adimem_record(TA_ADIMEM_CMD_READ, address, size, *value, TEEC_SUCCESS);
+		return TEEC_SUCCESS;
+	}
 
-	/* Close the session and destroy the context */
-	TEEC_CloseSession(&sess);
-	TEEC_FinalizeContext(&ctx);
+	*value = 0;
+	res = adimem_invoke_rw(session, TA_ADIMEM_CMD_READ, address, size, value);
+	if (res == TEEC_SUCCESS && session->cache != NULL)
+		adimem_cache_store(session->cache, address, size, *value);
 
 	return res;
 }
+
+/**
+ * adi_write_register - Write one register on an open session, invalidating its cache
+ */
+TEEC_Result adi_write_register(adimem_session_t *session, uint64_t address, size_t size, uint64_t value)
+{
+	/* Invalidate even on failure, the device state is unknown */
+	if (session->cache != NULL)
+		adimem_cache_invalidate(session->cache, address, size / 8);
+
+	return adimem_invoke_rw(session, TA_ADIMEM_CMD_WRITE, address, size, &value);
+}
+
+/**
+ * adi_digest_memory - Compute a digest of an address range inside the TA
+ *
+ * Only the digest crosses the world boundary, so checking megabytes of
+ * memory costs a single invoke. digest must hold ADIMEM_DIGEST_MAX_LEN bytes;
+ * digest_len returns the number of bytes written for the chosen algorithm.
+ */
+TEEC_Result adi_digest_memory(adimem_session_t *session, uint64_t address, uint64_t length, size_t size,
+			      enum adimem_digest_algo algo, uint8_t *digest, size_t *digest_len)
+{
+	TEEC_Result res;
+	adimem_range_params_t params;
+	TEEC_Value result = { 0 };
+
+	params.address = address;
+	params.length = length;
+	params.size = size;
+	params.arg = algo;
+	params.value = 0;
+
+	memset(digest, 0, ADIMEM_DIGEST_MAX_LEN);
+	res = adimem_invoke_range(session, TA_ADIMEM_CMD_DIGEST, &params, sizeof(params), digest,
+				  ADIMEM_DIGEST_MAX_LEN, TEEC_MEM_OUTPUT, &result);
+	if (res != TEEC_SUCCESS)
+		return res;
+
+	/* TA reports the digest length in result.a */
+	if (result.a > ADIMEM_DIGEST_MAX_LEN)
+		return TEEC_ERROR_BAD_FORMAT;
+	*digest_len = result.a;
+
+	return TEEC_SUCCESS;
+}
+
+/**
+ * adi_fill_memory - Fill an address range with a pattern inside the TA
+ */
+TEEC_Result adi_fill_memory(adimem_session_t *session, uint64_t address, uint64_t length, size_t size,
+			    enum adimem_pattern pattern, uint64_t value)
+{
+	adimem_range_params_t params;
+	TEEC_Value result = { 0 };
+
+	params.address = address;
+	params.length = length;
+	params.size = size;
+	params.arg = pattern;
+	params.value = value;
+
+	if (session->cache != NULL)
+		adimem_cache_invalidate(session->cache, address, length);
+
+	return adimem_invoke_range(session, TA_ADIMEM_CMD_FILL, &params, sizeof(params), NULL, 0, 0, &result);
+}
+
+/**
+ * adi_verify_memory - Check an address range against a pattern inside the TA
+ *
+ * mismatches returns the total number of words that differ from the pattern.
+ * On input num_failures is the capacity of failures; on output it is the
+ * number of failing addresses stored, in ascending order.
+ */
+TEEC_Result adi_verify_memory(adimem_session_t *session, uint64_t address, uint64_t length, size_t size,
+			      enum adimem_pattern pattern, uint64_t value, uint32_t *mismatches,
+			      uint64_t *failures, uint32_t *num_failures)
+{
+	TEEC_Result res;
+	adimem_range_params_t params;
+	TEEC_Value result = { 0 };
+
+	params.address = address;
+	params.length = length;
+	params.size = size;
+	params.arg = pattern;
+	params.value = value;
+
+	/* TA reports mismatches in result.a and stored failures in result.b */
+	res = adimem_invoke_range(session, TA_ADIMEM_CMD_VERIFY, &params, sizeof(params),
+				  (*num_failures != 0) ? failures : NULL,
+				  *num_failures * sizeof(uint64_t), TEEC_MEM_OUTPUT, &result);
+	if (res != TEEC_SUCCESS)
+		return res;
+
+	if (result.b > *num_failures)
+		return TEEC_ERROR_BAD_FORMAT;
+	*mismatches = result.a;
+	*num_failures = result.b;
+
+	return TEEC_SUCCESS;
+}
+
+/**
+ * adi_search_memory - Scan an address range for a masked byte pattern inside the TA
+ *
+ * mask may be NULL to match every bit. hits returns the total number of
+ * matches; on input num_offsets is the capacity of offsets, on output the
+ * number of match offsets (relative to address) stored, in ascending order.
+ */
+TEEC_Result adi_search_memory(adimem_session_t *session, uint64_t address, uint64_t length, size_t size,
+			      const uint8_t *pattern, const uint8_t *mask, size_t pattern_len, uint64_t step,
+			      uint32_t *hits, uint64_t *offsets, uint32_t *num_offsets)
+{
+	TEEC_Result res;
+	adimem_search_params_t params;
+	TEEC_Value result = { 0 };
+
+	if (pattern_len == 0 || pattern_len > ADIMEM_SEARCH_MAX_LEN || step == 0)
+		return TEEC_ERROR_BAD_PARAMETERS;
+
+	memset(&params, 0, sizeof(params));
+	params.range.address = address;
+	params.range.length = length;
+	params.range.size = size;
+	params.range.arg = pattern_len;
+	params.range.value = step;
+	memcpy(params.pattern, pattern, pattern_len);
+	if (mask != NULL)
+		memcpy(params.mask, mask, pattern_len);
+	else
+		memset(params.mask, 0xff, pattern_len);
+
+	/* TA reports total hits in result.a and stored offsets in result.b */
+	res = adimem_invoke_range(session, TA_ADIMEM_CMD_SEARCH, &params, sizeof(params),
+				  (*num_offsets != 0) ? offsets : NULL,
+				  *num_offsets * sizeof(uint64_t), TEEC_MEM_OUTPUT, &result);
+	if (res != TEEC_SUCCESS)
+		return res;
+
+	if (result.b > *num_offsets)
+		return TEEC_ERROR_BAD_FORMAT;
+	*hits = result.a;
+	*num_offsets = result.b;
+
+	return TEEC_SUCCESS;
+}
+
+/**
+ * adi_read_memory_bulk - Read an address range into buf with the widest aligned accesses
+ *
+ * The range is split into runs that share one access width: single narrow
+ * accesses up to the first max_size aligned address, one run of max_size
+ * accesses (in chunks of ADIMEM_BULK_CHUNK) and narrow accesses for the tail.
+ * Each run is a single TA_ADIMEM_CMD_READ_BULK invoke. max_size is the widest
+ * access in bits the bus allows (8, 16, 32 or 64).
+ */
+TEEC_Result adi_read_memory_bulk(adimem_session_t *session, uint64_t address, uint64_t length, size_t max_size,
+				 uint8_t *buf)
+{
+	TEEC_Result res;
+	adimem_range_params_t params;
+	TEEC_Value result = { 0 };
+	uint64_t max_bytes = max_size / 8;
+	uint64_t width, run;
+
+	if (max_bytes == 0 || max_bytes > 8 || (max_bytes & (max_bytes - 1)) != 0)
+		return TEEC_ERROR_BAD_PARAMETERS;
+
+	while (length > 0) {
+		/* Widest access that is aligned and fits in what is left */
+		width = max_bytes;
+		while (width > 1 && ((address & (width - 1)) != 0 || width > length))
+			width >>= 1;
+
+		if (width == max_bytes) {
+			run = length - (length % width);
+			if (run > ADIMEM_BULK_CHUNK)
+				run = ADIMEM_BULK_CHUNK - (ADIMEM_BULK_CHUNK % width);
+		} else {
+			run = width;
+		}
+
+		params.address = address;
+		params.length = run;
+		params.size = width * 8;
+		params.arg = 0;
+		params.value = 0;
+
+		res = adimem_invoke_range(session, TA_ADIMEM_CMD_READ_BULK, &params, sizeof(params),
+					  buf, run, TEEC_MEM_OUTPUT, &result);
+		if (res != TEEC_SUCCESS)
+			return res;
+
+		address += run;
+		buf += run;
+		length -= run;
+	}
+
+	return TEEC_SUCCESS;
+}
+
+/**
+ * adimem_invoke_batch - Send a list of register accesses in one invoke per ADIMEM_BATCH_MAX
+ */
+static TEEC_Result adimem_invoke_batch(adimem_session_t *session, adimem_access_t *accesses, uint32_t count,
+				       uint32_t *completed)
+{
+	TEEC_Result res = TEEC_SUCCESS;
+	TEEC_Operation op;
+	TEEC_SharedMemory access_buf;
+	uint32_t err_origin;
+	uint32_t done, n;
+
+	*completed = 0;
+
+	while (*completed < count) {
+		n = count - *completed;
+		if (n > ADIMEM_BATCH_MAX)
+			n = ADIMEM_BATCH_MAX;
+
+		/* Register shared memory */
+		memset((void *)&access_buf, 0, sizeof(access_buf));
+		access_buf.buffer = &accesses[*completed];
+		access_buf.size = n * sizeof(adimem_access_t);
+		access_buf.flags = TEEC_MEM_INPUT | TEEC_MEM_OUTPUT;
+
+		res = TEEC_RegisterSharedMemory(&session->ctx, &access_buf);
+		if (res != TEEC_SUCCESS) {
+			printf("TEEC_RegisterSharedMemory failed with code 0x%x\n", res);
+			return res;
+		}
+
+		/* Prepare the TEEC_Operation struct */
+		memset(&op, 0, sizeof(op));
+		op.paramTypes = TEEC_PARAM_TYPES(TEEC_MEMREF_WHOLE, TEEC_NONE, TEEC_VALUE_OUTPUT, TEEC_VALUE_INPUT);
+		op.params[OP_PARAM_RANGE].memref.parent = &access_buf;
+		op.params[OP_PARAM_RANGE].memref.size = access_buf.size;
+		op.params[OP_PARAM_PRIV].value.a = adimem_priv();
+
+		/* TA reports the number of accesses executed in result.a */
+		res = TEEC_InvokeCommand(&session->sess, TA_ADIMEM_CMD_BATCH, &op, &err_origin);
+		done = (res == TEEC_SUCCESS) ? n : op.params[OP_PARAM_RESULT].value.a;
+		if (done > n)
+			done = n;
+		TEEC_ReleaseSharedMemory(&access_buf);
+		*completed += done;
+
+		if (res != TEEC_SUCCESS) {
+			printf("tee_access_batch failed with code 0x%x origin 0x%x\n", res, err_origin);
+			return res;
+		}
+	}
+
+	return TEEC_SUCCESS;
+}
+
+/**
+ * adi_access_batch - Execute a list of register accesses in one invoke per ADIMEM_BATCH_MAX
+ *
+ * completed returns the number of accesses executed successfully. On error
+ * accesses[*completed].result holds the result of the failing access.
+ *
+ * With a session cache, reads it holds and repeated reads of an address
+ * not written in between are served on the host, only the rest of the list
+ * goes to the TA.
+ */
+TEEC_Result adi_access_batch(adimem_session_t *session, adimem_access_t *accesses, uint32_t count,
+			     uint32_t *completed)
+{
+	TEEC_Result res;
+	adimem_access_t misses[ADIMEM_BATCH_MAX];
+	int32_t source[ADIMEM_BATCH_MAX];       /* Index in misses, -1 if cached */
+	uint32_t done, n, window, first;
+	int32_t j;
+
+	if (session->cache == NULL) {
+		res = adimem_invoke_batch(session, accesses, count, completed);
+		for (uint32_t i = 0; i < *completed; i++)
+			adimem_record(accesses[i].cmd, accesses[i].address, accesses[i].size, accesses[i].value,
+				      TEEC_SUCCESS);
+		return res;
+	}
+
+	*completed = 0;
+	while (*completed < count) {
+		window = count - *completed;
+		if (window > ADIMEM_BATCH_MAX)
+			window = ADIMEM_BATCH_MAX;
+
+		/* Queue the accesses the host cannot serve, a write ends what later reads can hit */
+		n = 0;
+		first = 0;
+		for (uint32_t i = 0; i < window; i++) {
+			adimem_access_t *access = &accesses[*completed + i];
+
+			source[i] = -1;
+			if (access->cmd == TA_ADIMEM_CMD_WRITE) {
+				adimem_cache_invalidate(session->cache, access->address, access->size / 8);
+				first = n + 1;
+			} else if (adimem_cache_covers(session->cache, access->address, access->size)) {
+				for (j = n - 1; j >= (int32_t)first; j--)
+					if (misses[j].cmd == TA_ADIMEM_CMD_READ && misses[j].address == access->address &&
+					    misses[j].size == access->size)
+						break;
+				if (j >= (int32_t)first) {
+					session->cache->hits++;
+					source[i] = j;
+					continue;
+				}
+				if (adimem_cache_lookup(session->cache, access->address, access->size, &access->value)) {
+					access->result = TEEC_SUCCESS;
+					continue;
+				}
+			}
+			misses[n] = *access;
+			source[i] = n++;
+		}
+
+		res = adimem_invoke_batch(session, misses, n, &done);
+
+		/* Reads before a write of the same window saw the old value */
+		for (uint32_t i = 0; i < done; i++)
+			if (misses[i].cmd == TA_ADIMEM_CMD_READ)
+				adimem_cache_store(session->cache, misses[i].address, misses[i].size, misses[i].value);
+		for (uint32_t i = 0; i < n; i++)
+			if (misses[i].cmd == TA_ADIMEM_CMD_WRITE)
+				adimem_cache_invalidate(session->cache, misses[i].address, misses[i].size / 8);
+
+		/* Journal the window in list order, cache hits included */
+		for (uint32_t i = 0; i < window; i++) {
+			adimem_access_t *access = &accesses[*completed + i];
+
+			if (source[i] >= 0 && (uint32_t)source[i] >= done) {
+				/* The first access of the failing one holds its result */
+				access->result = misses[source[i]].result;
+				*completed += i;
+				return res;
+			}
+			if (source[i] >= 0)
+				*access = misses[source[i]];
+			adimem_record(access->cmd, access->address, access->size, access->value, TEEC_SUCCESS);
+		}
+		*completed += window;
+		if (res != TEEC_SUCCESS)
+			return res;
+	}
+
+	return TEEC_SUCCESS;
+}
@@ -30,13 +30,162 @@
 
 #include <tee_client_api.h>
 
+#include "cache.h"
+
 /* The function IDs implemented in this TA */
 enum ta_adimem_cmds {
 	TA_ADIMEM_CMD_READ,
 	TA_ADIMEM_CMD_WRITE,
+	TA_ADIMEM_CMD_DIGEST,
+	TA_ADIMEM_CMD_FILL,
+	TA_ADIMEM_CMD_VERIFY,
+	TA_ADIMEM_CMD_SEARCH,
+	TA_ADIMEM_CMD_READ_BULK,
+	TA_ADIMEM_CMD_BATCH,
+	/* New commands go above this comment.
+	 * Keep 'COUNT' as the last entry. */
 	TA_ADIMEM_CMDS_COUNT
 };
 
-TEEC_Result adi_readwrite_memory(enum ta_adimem_cmds command, uint64_t address, size_t size, uint32_t *rw_value);
+/* Digest algorithms computed by TA_ADIMEM_CMD_DIGEST */
+enum adimem_digest_algo {
+	ADIMEM_DIGEST_CRC32C,
+	ADIMEM_DIGEST_SHA256
+};
+
+/*
+ * Patterns generated by TA_ADIMEM_CMD_FILL and checked by TA_ADIMEM_CMD_VERIFY.
+ * Word i of the range (at address addr, access width w bits) holds:
+ */
+enum adimem_pattern {
+	ADIMEM_PATTERN_FIXED,           /* value */
+	ADIMEM_PATTERN_WALKING_ONES,    /* 1 << (i % w) */
+	ADIMEM_PATTERN_WALKING_ZEROS,   /* ~(1 << (i % w)) */
+	ADIMEM_PATTERN_ADDRESS,         /* addr */
+	ADIMEM_PATTERN_ADDRESS_INV,     /* ~addr */
+	ADIMEM_PATTERN_PRBS31,          /* next w bits of x^31 + x^28 + 1, seeded with value */
+	ADIMEM_PATTERNS_COUNT
+};
+
+#define ADIMEM_CRC32C_LEN 4
+#define ADIMEM_SHA256_LEN 32
+#define ADIMEM_DIGEST_MAX_LEN ADIMEM_SHA256_LEN
+
+/*
+ * Range description passed to the TA by commands that operate on a whole
+ * address range (digest, fill, ...). Layout is shared with the TA, so fields
+ * are fixed width.
+ */
+typedef struct adimem_range_params {
+	uint64_t address;       /* First address of the range */
+	uint64_t length;        /* Length of the range in bytes */
+	uint64_t size;          /* Access width in bits: 8, 16, 32, 64 */
+	uint64_t arg;           /* Command specific argument: algorithm, pattern */
+	uint64_t value;         /* Command specific value: fill value, seed */
+} adimem_range_params_t;
+
+#define ADIMEM_SEARCH_MAX_LEN 64
+
+/*
+ * Parameters of TA_ADIMEM_CMD_SEARCH. A match at offset off is where
+ * (byte[off + i] & mask[i]) == (pattern[i] & mask[i]) for every i < range.arg.
+ * Candidate offsets are multiples of range.value (the search step).
+ */
+typedef struct adimem_search_params {
+	adimem_range_params_t range;
+	uint8_t pattern[ADIMEM_SEARCH_MAX_LEN];
+	uint8_t mask[ADIMEM_SEARCH_MAX_LEN];
+} adimem_search_params_t;
+
+/*
+ * One register access of a TA_ADIMEM_CMD_BATCH invoke. The TA executes the
+ * array in order, stores each access result (and read value) in place and
+ * stops at the first failing access.
+ */
+typedef struct adimem_access {
+	uint64_t address;
+	uint64_t value;
+	uint32_t cmd;           /* TA_ADIMEM_CMD_READ or TA_ADIMEM_CMD_WRITE */
+	uint32_t size;          /* Access width in bits */
+	uint32_t result;        /* TEE result of this access */
+	uint32_t reserved;
+} adimem_access_t;
+
+/* Largest number of accesses sent in one TA_ADIMEM_CMD_BATCH invoke */
+#define ADIMEM_BATCH_MAX 256
+
+/*
+ * Access journal written in record mode: a header followed by one
+ * fixed size entry per access, in execution order.
+ */
+#define ADIMEM_JOURNAL_MAGIC 0x524a4441 /* "ADJR" */
+#define ADIMEM_JOURNAL_VERSION 1
+#define ADIMEM_RECORD_ENV "ADIMEM_RECORD"
+
+typedef struct adimem_journal_header {
+	uint32_t magic;
+	uint32_t version;
+} adimem_journal_header_t;
+
+typedef struct adimem_journal_entry {
+	uint64_t timestamp;     /* CLOCK_REALTIME in ns */
+	uint64_t address;
+	uint64_t value;         /* Value written, or value read */
+	uint32_t result;        /* TEEC result of the access */
+	uint8_t cmd;            /* TA_ADIMEM_CMD_READ or TA_ADIMEM_CMD_WRITE */
+	uint8_t size;           /* Access width in bits */
+	uint16_t reserved;
+} adimem_journal_entry_t;
+
+/* Replay flags */
+#define ADIMEM_REPLAY_TIMED (1 << 0)    /* Keep the recorded spacing of accesses */
+#define ADIMEM_REPLAY_VERIFY (1 << 1)   /* Check reads and read back writes */
+
+/*
+ * Open context and session to the adimem TA, reusable across commands.
+ * Register reads and writes on the session go through cache when it is
+ * set (NULL after adimem_open_session()).
+ */
+typedef struct adimem_session {
+	TEEC_Context ctx;
+	TEEC_Session sess;
+	adimem_cache_t *cache;
+} adimem_session_t;
+
+/*
+ * Register cache of the address lists, register names and --replay:
+ * "policy@start+length,..." with policy a time to live in ms, 0 to keep
+ * reads until written, or never.
+ */
+#define ADIMEM_CACHE_ENV "ADIMEM_CACHE"
+
+TEEC_Result adimem_open_session(adimem_session_t *session);
+void adimem_close_session(adimem_session_t *session);
+
+/* Largest number of bytes moved by a single TA_ADIMEM_CMD_READ_BULK invoke */
+#define ADIMEM_BULK_CHUNK (1024 * 1024)
+
+TEEC_Result adi_readwrite_memory(enum ta_adimem_cmds command, uint64_t address, size_t size, uint64_t *rw_value);
+TEEC_Result adi_read_register(adimem_session_t *session, uint64_t address, size_t size, uint64_t *value);
+TEEC_Result adi_write_register(adimem_session_t *session, uint64_t address, size_t size, uint64_t value);
+TEEC_Result adi_read_memory_bulk(adimem_session_t *session, uint64_t address, uint64_t length, size_t max_size,
+				 uint8_t *buf);
+TEEC_Result adi_access_batch(adimem_session_t *session, adimem_access_t *accesses, uint32_t count,
+			     uint32_t *completed);
+
+bool adimem_record_start(const char *path);
+void adimem_record_stop(void);
+void adimem_record(uint32_t cmd, uint64_t address, size_t size, uint64_t value, TEEC_Result result);
+TEEC_Result adimem_replay(const char *path, uint32_t flags, adimem_cache_t *cache, uint32_t *mismatches);
+TEEC_Result adi_digest_memory(adimem_session_t *session, uint64_t address, uint64_t length, size_t size,
+			      enum adimem_digest_algo algo, uint8_t *digest, size_t *digest_len);
+TEEC_Result adi_fill_memory(adimem_session_t *session, uint64_t address, uint64_t length, size_t size,
+			    enum adimem_pattern pattern, uint64_t value);
+TEEC_Result adi_verify_memory(adimem_session_t *session, uint64_t address, uint64_t length, size_t size,
+			      enum adimem_pattern pattern, uint64_t value, uint32_t *mismatches,
+			      uint64_t *failures, uint32_t *num_failures);
+TEEC_Result adi_search_memory(adimem_session_t *session, uint64_t address, uint64_t length, size_t size,
+			      const uint8_t *pattern, const uint8_t *mask, size_t pattern_len, uint64_t step,
+			      uint32_t *hits, uint64_t *offsets, uint32_t *num_offsets);
 
 #endif /* ADIMEM_H */
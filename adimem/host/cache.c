@@ -0,0 +1,238 @@
+/*
+ * Copyright (c) 2026, Analog Devices Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "cache.h"
+
+/**
+ * now_ns - CLOCK_MONOTONIC in ns
+ */
+static uint64_t now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/**
+ * cache_set - first entry of the set holding the 8 byte block of address
+ */
+static adimem_cache_entry_t *cache_set(adimem_cache_t *cache, uint64_t address)
+{
+	uint64_t block = address >> 3;
+
+	/* Fibonacci hashing spreads strided register blocks over the sets */
+	block *= 0x9e3779b97f4a7c15ULL;
+	return &cache->entries[(block >> 32) & (cache->num_sets - 1)];
+}
+
+/**
+ * cache_range - range covering an access, NULL if none
+ */
+static const adimem_cache_range_t *cache_range(adimem_cache_t *cache, uint64_t address, uint32_t size)
+{
+	for (uint32_t i = 0; i < cache->num_ranges; i++) {
+		const adimem_cache_range_t *range = &cache->ranges[i];
+
+		if (address >= range->start && address + size / 8 <= range->end)
+			return range;
+	}
+	return NULL;
+}
+
+/**
+ * cacheable - true for naturally aligned accesses of a supported width
+ */
+static bool cacheable(uint64_t address, uint32_t size)
+{
+	if (size != 8 && size != 16 && size != 32 && size != 64)
+		return false;
+	return (address & (size / 8 - 1)) == 0;
+}
+
+/**
+ * adimem_cache_init - allocate an empty cache of num_sets sets
+ */
+bool adimem_cache_init(adimem_cache_t *cache, uint32_t num_sets)
+{
+	memset(cache, 0, sizeof(*cache));
+
+	if (num_sets == 0 || (num_sets & (num_sets - 1)) != 0)
+		return false;
+
+	cache->entries = calloc((size_t)num_sets * ADIMEM_CACHE_WAYS, sizeof(adimem_cache_entry_t));
+	if (cache->entries == NULL)
+		return false;
+	cache->num_sets = num_sets;
+
+	return true;
+}
+
+/**
+ * adimem_cache_free - release the cache entries
+ */
+void adimem_cache_free(adimem_cache_t *cache)
+{
+	free(cache->entries);
+	memset(cache, 0, sizeof(*cache));
+}
+
+/**
+ * adimem_cache_add_range - set the policy of an address range
+ *
+ * Ranges are matched in the order they were added, so add specific
+ * exceptions (e.g. ADIMEM_CACHE_NEVER for a status register) before the
+ * block that contains them.
+ */
+bool adimem_cache_add_range(adimem_cache_t *cache, uint64_t start, uint64_t length,
+			    enum adimem_cache_policy policy, uint32_t ttl_ms)
+{
+	adimem_cache_range_t *range;
+
+	if (cache->num_ranges == ADIMEM_CACHE_MAX_RANGES || length == 0 || start + length < start)
+		return false;
+
+	range = &cache->ranges[cache->num_ranges++];
+	range->start = start;
+	range->end = start + length;
+	range->policy = policy;
+	range->ttl = (uint64_t)ttl_ms * 1000000ULL;
+
+	return true;
+}
+
+/**
+ * adimem_cache_covers - true if reads of an access may be served from the cache
+ */
+bool adimem_cache_covers(adimem_cache_t *cache, uint64_t address, uint32_t size)
+{
+	const adimem_cache_range_t *range = cache_range(cache, address, size);
+
+	return range != NULL && range->policy != ADIMEM_CACHE_NEVER && cacheable(address, size);
+}
+
+/**
+ * adimem_cache_lookup - serve a read from the cache
+ *
+ * Returns true on a hit. Reads of never-cached addresses are not counted.
+ */
+bool adimem_cache_lookup(adimem_cache_t *cache, uint64_t address, uint32_t size, uint64_t *value)
+{
+	const adimem_cache_range_t *range = cache_range(cache, address, size);
+	adimem_cache_entry_t *set;
+
+	if (range == NULL || range->policy == ADIMEM_CACHE_NEVER || !cacheable(address, size))
+		return false;
+
+	set = cache_set(cache, address);
+	for (uint32_t way = 0; way < ADIMEM_CACHE_WAYS; way++) {
+		adimem_cache_entry_t *entry = &set[way];
+
+		if (entry->size != size || entry->address != address)
+			continue;
+		if (entry->expires != 0 && now_ns() >= entry->expires) {
+			entry->size = 0;
+			break;
+		}
+		*value = entry->value;
+		cache->hits++;
+		return true;
+	}
+
+	cache->misses++;
+	return false;
+}
+
+/**
+ * adimem_cache_store - remember a value read from the device
+ */
+void adimem_cache_store(adimem_cache_t *cache, uint64_t address, uint32_t size, uint64_t value)
+{
+	const adimem_cache_range_t *range = cache_range(cache, address, size);
+	adimem_cache_entry_t *set, *entry = NULL;
+
+	if (range == NULL || range->policy == ADIMEM_CACHE_NEVER || !cacheable(address, size))
+		return;
+
+	/* Reuse the entry for this key or a free way, else evict round robin */
+	set = cache_set(cache, address);
+	for (uint32_t way = 0; way < ADIMEM_CACHE_WAYS && entry == NULL; way++)
+		if (set[way].size == size && set[way].address == address)
+			entry = &set[way];
+	for (uint32_t way = 0; way < ADIMEM_CACHE_WAYS && entry == NULL; way++)
+		if (set[way].size == 0)
+			entry = &set[way];
+	if (entry == NULL)
+		entry = &set[cache->next_way++ % ADIMEM_CACHE_WAYS];
+
+	entry->address = address;
+	entry->size = size;
+	entry->value = value;
+	entry->expires = (range->policy == ADIMEM_CACHE_TTL) ? now_ns() + range->ttl : 0;
+}
+
+/**
+ * adimem_cache_invalidate - drop every entry overlapping a written range
+ */
+void adimem_cache_invalidate(adimem_cache_t *cache, uint64_t address, uint64_t length)
+{
+	uint64_t end = address + length;
+	uint64_t block;
+
+	if (length == 0)
+		return;
+
+	/* Large ranges: sweep the whole table instead of block by block */
+	if (length / 8 >= (uint64_t)cache->num_sets * ADIMEM_CACHE_WAYS) {
+		for (uint64_t i = 0; i < (uint64_t)cache->num_sets * ADIMEM_CACHE_WAYS; i++) {
+			adimem_cache_entry_t *entry = &cache->entries[i];
+
+			if (entry->size != 0 && entry->address < end && entry->address + entry->size / 8 > address) {
+				entry->size = 0;
+				cache->invalidations++;
+			}
+		}
+		return;
+	}
+
+	for (block = address & ~7ULL; block < end; block += 8) {
+		adimem_cache_entry_t *set = cache_set(cache, block);
+
+		for (uint32_t way = 0; way < ADIMEM_CACHE_WAYS; way++) {
+			adimem_cache_entry_t *entry = &set[way];
+
+			if (entry->size != 0 && entry->address < end && entry->address + entry->size / 8 > address) {
+				entry->size = 0;
+				cache->invalidations++;
+			}
+		}
+	}
+}
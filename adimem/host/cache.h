@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2026, Analog Devices Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* How reads of an address range may be served from the cache */
+enum adimem_cache_policy {
+	ADIMEM_CACHE_NEVER,             /* Always read from the device */
+	ADIMEM_CACHE_TTL,               /* Cached for a fixed time after each read */
+	ADIMEM_CACHE_UNTIL_WRITE        /* Cached until written through the library */
+};
+
+#define ADIMEM_CACHE_MAX_RANGES 32
+#define ADIMEM_CACHE_WAYS 4
+
+typedef struct adimem_cache_range {
+	uint64_t start;
+	uint64_t end;                   /* Exclusive */
+	uint64_t ttl;                   /* ns, ADIMEM_CACHE_TTL only */
+	enum adimem_cache_policy policy;
+} adimem_cache_range_t;
+
+typedef struct adimem_cache_entry {
+	uint64_t address;
+	uint64_t value;
+	uint64_t expires;               /* CLOCK_MONOTONIC ns, 0 for never */
+	uint32_t size;                  /* Access width in bits, 0 if unused */
+	uint32_t reserved;
+} adimem_cache_entry_t;
+
+/*
+ * Read-mostly register cache, keyed by address and access width.
+ *
+ * Entries live in a set associative table indexed by the 8 byte block of
+ * their address. Only naturally aligned accesses are cached, so every entry
+ * overlapping a write is in the set of the written block. Addresses not
+ * covered by a range are never cached.
+ */
+typedef struct adimem_cache {
+	adimem_cache_range_t ranges[ADIMEM_CACHE_MAX_RANGES];
+	uint32_t num_ranges;
+	adimem_cache_entry_t *entries;  /* num_sets * ADIMEM_CACHE_WAYS */
+	uint32_t num_sets;              /* Power of two */
+	uint32_t next_way;
+	uint64_t hits;
+	uint64_t misses;
+	uint64_t invalidations;
+} adimem_cache_t;
+
+bool adimem_cache_init(adimem_cache_t *cache, uint32_t num_sets);
+void adimem_cache_free(adimem_cache_t *cache);
+bool adimem_cache_add_range(adimem_cache_t *cache, uint64_t start, uint64_t length,
+			    enum adimem_cache_policy policy, uint32_t ttl_ms);
+bool adimem_cache_covers(adimem_cache_t *cache, uint64_t address, uint32_t size);
+bool adimem_cache_lookup(adimem_cache_t *cache, uint64_t address, uint32_t size, uint64_t *value);
+void adimem_cache_store(adimem_cache_t *cache, uint64_t address, uint32_t size, uint64_t value);
+void adimem_cache_invalidate(adimem_cache_t *cache, uint64_t address, uint64_t length);
+
+#endif /* CACHE_H */
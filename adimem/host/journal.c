@@ -0,0 +1,300 @@
+/*
+ * Copyright (c) 2026, Analog Devices Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "adimem.h"
+
+/* In timed replay, accesses recorded this close together share a batch */
+#define REPLAY_WINDOW_NS 1000000ULL
+
+/* Journal of the record mode, NULL when not recording */
+static FILE *record_fp;
+
+/**
+ * now_ns - a clock reading in ns
+ */
+static uint64_t now_ns(clockid_t clock)
+{
+	struct timespec ts;
+
+	clock_gettime(clock, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/**
+ * width_mask - mask of the bits covered by an access of size bits
+ */
+static uint64_t width_mask(uint32_t size)
+{
+	return (size >= 64) ? ~0ULL : ((1ULL << size) - 1);
+}
+
+/**
+ * adimem_record_start - Append every subsequent register access to a journal
+ *
+ * The journal is opened for append so that several processes (e.g. a shell
+ * script calling optee_app_adimem repeatedly) build up a single journal.
+ */
+bool adimem_record_start(const char *path)
+{
+	adimem_journal_header_t hdr;
+
+	adimem_record_stop();
+
+	record_fp = fopen(path, "ab");
+	if (record_fp == NULL) {
+		printf("Unable to open journal %s\n", path);
+		return false;
+	}
+
+	/* New journal: write the header first */
+	if (ftell(record_fp) == 0) {
+		hdr.magic = ADIMEM_JOURNAL_MAGIC;
+		hdr.version = ADIMEM_JOURNAL_VERSION;
+		if (fwrite(&hdr, sizeof(hdr), 1, record_fp) != 1) {
+			printf("Unable to write to journal %s\n", path);
+			fclose(record_fp);
+			record_fp = NULL;
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/**
+ * adimem_record_stop - Flush and close the journal
+ */
+void adimem_record_stop(void)
+{
+	if (record_fp == NULL)
+		return;
+
+	if (fclose(record_fp) != 0)
+		printf("Unable to close journal\n");
+	record_fp = NULL;
+}
+
+/**
+ * adimem_record - Append one access to the journal, if recording
+ */
+void adimem_record(uint32_t cmd, uint64_t address, size_t size, uint64_t value, TEEC_Result result)
+{
+	adimem_journal_entry_t entry;
+
+	if (record_fp == NULL)
+		return;
+
+	memset(&entry, 0, sizeof(entry));
+	entry.timestamp = now_ns(CLOCK_REALTIME);
+	entry.address = address;
+	entry.value = value;
+	entry.result = result;
+	entry.cmd = cmd;
+	entry.size = size;
+
+	if (fwrite(&entry, sizeof(entry), 1, record_fp) != 1) {
+		printf("Unable to write to journal, recording stopped\n");
+		adimem_record_stop();
+	}
+}
+
+/**
+ * replay_flush - Execute a batch and check it against the journal
+ *
+ * expected[i] is the value access i should return when verifying: the
+ * recorded read value, or the written value for a read back.
+ */
+static TEEC_Result replay_flush(adimem_session_t *session, adimem_access_t *batch, const uint64_t *expected,
+				const bool *check, uint32_t count, uint32_t *mismatches)
+{
+	TEEC_Result res;
+	uint32_t completed;
+
+	res = adi_access_batch(session, batch, count, &completed);
+	if (res != TEEC_SUCCESS) {
+		printf("Replay stopped at 0x%llx\n", (unsigned long long)batch[completed].address);
+		return res;
+	}
+
+	for (uint32_t i = 0; i < count; i++) {
+		uint64_t mask = width_mask(batch[i].size);
+
+		if (!check[i] || (batch[i].value & mask) == (expected[i] & mask))
+			continue;
+		printf("Mismatch at 0x%llx: expected 0x%llx got 0x%llx\n",
+		       (unsigned long long)batch[i].address, (unsigned long long)(expected[i] & mask),
+		       (unsigned long long)(batch[i].value & mask));
+		(*mismatches)++;
+	}
+
+	return TEEC_SUCCESS;
+}
+
+/**
+ * replay_wait - In timed replay, sleep until a recorded access is due
+ */
+static void replay_wait(uint64_t first_recorded, uint64_t start, uint64_t recorded)
+{
+	uint64_t due = start + (recorded - first_recorded);
+	uint64_t now = now_ns(CLOCK_MONOTONIC);
+	struct timespec ts;
+
+	if (due <= now)
+		return;
+	ts.tv_sec = (due - now) / 1000000000ULL;
+	ts.tv_nsec = (due - now) % 1000000000ULL;
+	while (nanosleep(&ts, &ts) != 0 && errno == EINTR)
+		;
+}
+
+/**
+ * adimem_replay - Re-execute a journal through batched invokes
+ *
+ * Accesses that failed when recorded are skipped. With ADIMEM_REPLAY_TIMED
+ * accesses keep their recorded spacing (to within REPLAY_WINDOW_NS),
+ * otherwise they run at full speed. With ADIMEM_REPLAY_VERIFY reads are
+ * compared with their recorded values and every write is read back;
+ * mismatches returns the number of differences. cache (optional) serves
+ * the reads it holds, see adi_access_batch().
+ */
+TEEC_Result adimem_replay(const char *path, uint32_t flags, adimem_cache_t *cache, uint32_t *mismatches)
+{
+	TEEC_Result res = TEEC_SUCCESS;
+	adimem_session_t session;
+	const adimem_journal_header_t *hdr;
+	const adimem_journal_entry_t *entries;
+	/* Each entry may add a read back, so a batch holds two accesses per entry */
+	adimem_access_t batch[2 * ADIMEM_BATCH_MAX];
+	uint64_t expected[2 * ADIMEM_BATCH_MAX];
+	bool check[2 * ADIMEM_BATCH_MAX];
+	uint32_t count = 0;
+	uint64_t first_recorded = 0, batch_recorded = 0, start = 0;
+	size_t num_entries;
+	struct stat st;
+	void *base;
+	int fd;
+
+	*mismatches = 0;
+
+	fd = open(path, O_RDONLY);
+	if (fd < 0) {
+		printf("Unable to open journal %s\n", path);
+		return TEEC_ERROR_ITEM_NOT_FOUND;
+	}
+	if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(*hdr)) {
+		printf("Invalid journal %s\n", path);
+		close(fd);
+		return TEEC_ERROR_BAD_FORMAT;
+	}
+	base = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (base == MAP_FAILED) {
+		printf("Unable to map journal %s\n", path);
+		return TEEC_ERROR_GENERIC;
+	}
+
+	hdr = base;
+	if (hdr->magic != ADIMEM_JOURNAL_MAGIC || hdr->version != ADIMEM_JOURNAL_VERSION) {
+		printf("Invalid journal %s\n", path);
+		munmap(base, st.st_size);
+		return TEEC_ERROR_BAD_FORMAT;
+	}
+	entries = (const adimem_journal_entry_t *)(hdr + 1);
+	num_entries = (st.st_size - sizeof(*hdr)) / sizeof(adimem_journal_entry_t);
+
+	res = adimem_open_session(&session);
+	if (res != TEEC_SUCCESS) {
+		munmap(base, st.st_size);
+		return res;
+	}
+	session.cache = cache;
+
+	for (size_t i = 0; i < num_entries; i++) {
+		const adimem_journal_entry_t *entry = &entries[i];
+
+		if (entry->result != TEEC_SUCCESS ||
+		    (entry->cmd != TA_ADIMEM_CMD_READ && entry->cmd != TA_ADIMEM_CMD_WRITE))
+			continue;
+
+		if (start == 0) {
+			first_recorded = entry->timestamp;
+			start = now_ns(CLOCK_MONOTONIC);
+		}
+
+		/* Flush when full, or when the next access is not due yet */
+		if (count > 2 * ADIMEM_BATCH_MAX - 2 ||
+		    (count > 0 && (flags & ADIMEM_REPLAY_TIMED) &&
+		     entry->timestamp - batch_recorded > REPLAY_WINDOW_NS)) {
+			res = replay_flush(&session, batch, expected, check, count, mismatches);
+			if (res != TEEC_SUCCESS)
+				break;
+			count = 0;
+		}
+
+		if (count == 0) {
+			batch_recorded = entry->timestamp;
+			if (flags & ADIMEM_REPLAY_TIMED)
+				replay_wait(first_recorded, start, entry->timestamp);
+		}
+
+		memset(&batch[count], 0, sizeof(batch[count]));
+		batch[count].address = entry->address;
+		batch[count].cmd = entry->cmd;
+		batch[count].size = entry->size;
+		batch[count].value = (entry->cmd == TA_ADIMEM_CMD_WRITE) ? entry->value : 0;
+		expected[count] = entry->value;
+		check[count] = (flags & ADIMEM_REPLAY_VERIFY) && entry->cmd == TA_ADIMEM_CMD_READ;
+		count++;
+
+		if ((flags & ADIMEM_REPLAY_VERIFY) && entry->cmd == TA_ADIMEM_CMD_WRITE) {
+			memset(&batch[count], 0, sizeof(batch[count]));
+			batch[count].address = entry->address;
+			batch[count].cmd = TA_ADIMEM_CMD_READ;
+			batch[count].size = entry->size;
+			expected[count] = entry->value;
+			check[count] = true;
+			count++;
+		}
+	}
+
+	if (res == TEEC_SUCCESS && count > 0)
+		res = replay_flush(&session, batch, expected, check, count, mismatches);
+
+	adimem_close_session(&session);
+	munmap(base, st.st_size);
+
+	return res;
+}
@@ -27,32 +27,159 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
 #include "adimem.h"
+#include "hexdump.h"
+#include "regmap.h"
+#include "snapshot.h"
 
 /* Command line arguments */
 #define ARG_ADDR 1
 #define ARG_SIZE 2
 #define ARG_DATA 3
 
+/* Command line arguments when addressing a register by name */
+#define ARG_NAME 1
+#define ARG_NAME_DATA 2
+
+/* Command line arguments of the range commands */
+#define ARG_OPTION 1
+#define ARG_RANGE_ADDR 2
+#define ARG_RANGE_LENGTH 3
+#define ARG_RANGE_EXPECTED 4
+#define ARG_RANGE_VALUE 4
+#define ARG_RANGE_SIZE 4
+#define ARG_RANGE_PATTERN 4
+#define ARG_RANGE_MASK 5
+#define ARG_RANGE_FILL_SIZE 5
+#define ARG_RANGE_FILE 4
+#define ARG_RANGE_FILE_SIZE 5
+#define ARG_RANGE_FORMAT 4
+
+/* Command line arguments of --diff */
+#define ARG_DIFF_OLD 2
+#define ARG_DIFF_NEW 3
+#define ARG_DIFF_SIZE 4
+
+/* Access width in bits of the reads digested by --crc32c and --sha256 */
+#define DIGEST_SIZE 32
+
+/* Number of match offsets returned by --search */
+#define SEARCH_MAX_HITS 1024
+
+/* Bytes read per invoke by --hexdump */
+#define HEX_READ_CHUNK (64 * 1024)
+
+/* Sets of the register cache enabled by $ADIMEM_CACHE */
+#define CACHE_SETS 256
+
+/* Number of failing addresses reported per memtest pattern */
+#define MEMTEST_MAX_FAILURES 8
+
+/* Patterns run by --memtest, in order */
+struct memtest_step {
+	const char *name;
+	enum adimem_pattern pattern;
+	uint64_t value;
+};
+
+static const struct memtest_step memtest_suite[] = {
+	{ "fixed-0x55",    ADIMEM_PATTERN_FIXED,         0x5555555555555555ULL },
+	{ "fixed-0xaa",    ADIMEM_PATTERN_FIXED,         0xaaaaaaaaaaaaaaaaULL },
+	{ "walking-ones",  ADIMEM_PATTERN_WALKING_ONES,  0 },
+	{ "walking-zeros", ADIMEM_PATTERN_WALKING_ZEROS, 0 },
+	{ "address",       ADIMEM_PATTERN_ADDRESS,       0 },
+	{ "address-inv",   ADIMEM_PATTERN_ADDRESS_INV,   0 },
+	{ "prbs31",        ADIMEM_PATTERN_PRBS31,        1 },
+};
+
 /* Command help */
 #define HELP "\n\
-Usage: %s address [size [data] ] \n\
-  - address: decimal or hexadecimal (stared by 0x) \n\
-  - size:    8, 16, 32 (default) \n\
-  - data:    decimal or hexadecimal (started by 0x) \n\
+Usage: %1$s address [size [data] ] \n\
+       %1$s [--list] [-s size] address|start-end[/step] ... \n\
+       %1$s BLOCK.REG[.FIELD] [data] \n\
+       %1$s --crc32c|--sha256 address length [expected] \n\
+       %1$s --fill address length value [size] \n\
+       %1$s --memtest address length [size] \n\
+       %1$s --search address length pattern [mask] \n\
+       %1$s --dump address length file \n\
+       %1$s --hexdump address length [format] \n\
+       %1$s --replay journal [--timed] [--verify] \n\
+       %1$s --snapshot address length file [size] \n\
+       %1$s --diff old-snapshot new-snapshot|live [size] \n\
+  - address:  decimal or hexadecimal (stared by 0x) \n\
+  - size:     8, 16, 32 (default), 64 \n\
+  - data:     decimal or hexadecimal (started by 0x) \n\
+  - length:   number of bytes, decimal or hexadecimal (started by 0x), a \n\
+              multiple of the access size (32 bits for --crc32c, --sha256) \n\
+  - expected: digest to compare against, hexadecimal \n\
+  - value:    fill value, decimal or hexadecimal (started by 0x) \n\
+  - pattern:  bytes to search for, hexadecimal (e.g. 0xdeadbeef) \n\
+  - mask:     bits of pattern to compare, hexadecimal, same length as pattern \n\
+  - file:     output file for the bytes read \n\
+  - format:   width[:little|big], width 1, 2, 4 (default) or 8 bytes per \n\
+              word, also the access size; host byte order by default \n\
+  - start-end[/step]: every step bytes (default: size / 8) from start, \n\
+              end excluded \n\
+  - live:     compare against the current contents of the snapshot region \n\
+\n\
+Register names are resolved through the compiled register map in $" REGMAP_ENV " \n\
+(default " REGMAP_DEFAULT_PATH "), see %1$s_regmap. Reads of a \n\
+register are decoded into its fields; writes to a field read-modify-write \n\
+the register. \n\
+\n\
+Several addresses and ranges are read over one session in batches and \n\
+printed one per line. Up to three plain addresses are always read as \n\
+address [size [data]]: give --list or -s size first to read them as a list. \n\
+\n\
+Set $" ADIMEM_RECORD_ENV " to a journal file to record every register access. \n\
+--replay re-executes a journal at full speed, or with --timed at the \n\
+recorded pace; --verify checks reads against the journal and reads back \n\
+every write. \n\
+\n\
+Set $" ADIMEM_CACHE_ENV " to policy@start+length,... to serve repeated reads of \n\
+registers in those ranges from a cache. policy is a time in ms to keep a \n\
+read for, 0 to keep it until written, or never. Ranges are matched in \n\
+order, put never ranges of status and FIFO registers first; nothing else \n\
+is cached. Address lists, register names and --replay use the cache and \n\
+print its counters. \n\
 \n"
 
+/* Register cache from $ADIMEM_CACHE, NULL when unset */
+static adimem_cache_t register_cache;
+static adimem_cache_t *cache;
+
 /* Functions definition */
 bool parse_value32(char *data, uint32_t *value);
 bool parse_value64(char *data, uint64_t *value);
+bool parse_size(char *data, uint64_t *size);
+bool parse_hex_string(char *data, uint8_t *buf, size_t max_len, size_t *len);
+bool parse_hex_bytes(char *data, uint8_t *buf, size_t len);
+int run_digest(int argc, char *argv[], enum adimem_digest_algo algo);
+int run_fill(int argc, char *argv[]);
+int run_memtest(int argc, char *argv[]);
+int run_search(int argc, char *argv[]);
+int run_dump(int argc, char *argv[]);
+int run_hexdump(int argc, char *argv[]);
+int run_symbolic(int argc, char *argv[]);
+int run_replay(int argc, char *argv[]);
+int run_snapshot(int argc, char *argv[]);
+int run_diff(int argc, char *argv[]);
+bool is_address_list(int argc, char *argv[]);
+int run_list(int argc, char *argv[]);
+bool cache_start(char *ttl);
+void cache_stop(void);
+void cache_report(void);
 
 /* MAIN */
 int main(int argc, char *argv[])
 {
 	enum ta_adimem_cmds cmd = TA_ADIMEM_CMD_READ;
-	size_t cmd_size = 32;
+	uint64_t cmd_size = 32;
 	uint64_t cmd_address;
-	uint32_t cmd_rw_value = 0;
+	uint64_t cmd_rw_value = 0;
 
 	/* Check at least address is provided */
 	if (argc < 2) {
@@ -60,12 +187,50 @@ int main(int argc, char *argv[])
 		return 1;
 	}
 
-	/* Parse address */
-	if (!parse_value64(argv[ARG_ADDR], &cmd_address)) {
-		printf("Invalid address '%s'.\n", argv[ARG_ADDR]);
-		return 1;
+	/* Record mode */
+	if (getenv(ADIMEM_RECORD_ENV) != NULL) {
+		if (!adimem_record_start(getenv(ADIMEM_RECORD_ENV)))
+			return 1;
+		atexit(adimem_record_stop);
 	}
 
+	/* Register cache */
+	if (getenv(ADIMEM_CACHE_ENV) != NULL) {
+		if (!cache_start(getenv(ADIMEM_CACHE_ENV)))
+			return 1;
+		atexit(cache_stop);
+	}
+
+	/* Range commands */
+	if (strcmp(argv[ARG_OPTION], "--crc32c") == 0)
+		return run_digest(argc, argv, ADIMEM_DIGEST_CRC32C);
+	if (strcmp(argv[ARG_OPTION], "--sha256") == 0)
+		return run_digest(argc, argv, ADIMEM_DIGEST_SHA256);
+	if (strcmp(argv[ARG_OPTION], "--fill") == 0)
+		return run_fill(argc, argv);
+	if (strcmp(argv[ARG_OPTION], "--memtest") == 0)
+		return run_memtest(argc, argv);
+	if (strcmp(argv[ARG_OPTION], "--search") == 0)
+		return run_search(argc, argv);
+	if (strcmp(argv[ARG_OPTION], "--dump") == 0)
+		return run_dump(argc, argv);
+	if (strcmp(argv[ARG_OPTION], "--hexdump") == 0)
+		return run_hexdump(argc, argv);
+	if (strcmp(argv[ARG_OPTION], "--replay") == 0)
+		return run_replay(argc, argv);
+	if (strcmp(argv[ARG_OPTION], "--snapshot") == 0)
+		return run_snapshot(argc, argv);
+	if (strcmp(argv[ARG_OPTION], "--diff") == 0)
+		return run_diff(argc, argv);
+
+	/* Address lists and ranges */
+	if (is_address_list(argc, argv))
+		return run_list(argc, argv);
+
+	/* Parse address, anything that is not a number is a register name */
+	if (!parse_value64(argv[ARG_ADDR], &cmd_address))
+		return run_symbolic(argc, argv);
+
 	/* Parse data size */
 	if (argc > 2) {
 		if (!parse_value64(argv[ARG_SIZE], &cmd_size)) {
@@ -78,6 +243,7 @@ int main(int argc, char *argv[])
 	case  8: break;
 	case 16: break;
 	case 32: break;
+	case 64: break;
 	default:
 		printf("Invalid size '%s'.\n", argv[ARG_SIZE]);
 		return 1;
@@ -86,7 +252,7 @@ int main(int argc, char *argv[])
 	/* Parse value to write */
 	if (argc > 3) {
 		cmd = TA_ADIMEM_CMD_WRITE;
-		if (!parse_value32(argv[ARG_DATA], &cmd_rw_value)) {
+		if (!parse_value64(argv[ARG_DATA], &cmd_rw_value)) {
 			printf("Invalid value '%s'.\n", argv[ARG_DATA]);
 			return 1;
 		}
@@ -95,7 +261,7 @@ int main(int argc, char *argv[])
 	/* Execute tee stuff */
 	if (adi_readwrite_memory(cmd, cmd_address, cmd_size, &cmd_rw_value) == TEEC_SUCCESS) {
 		if (cmd == TA_ADIMEM_CMD_READ)
-			printf("0x%x\n", cmd_rw_value);
+			printf("0x%llx\n", (unsigned long long)cmd_rw_value);
 		return 0;
 	}
 
@@ -109,7 +275,7 @@ bool parse_value32(char *data, uint32_t *value)
 {
 	char *end;
 
-	*value = strtol(data, &end, 0);
+	*value = strtoul(data, &end, 0);
 	if (*end != '\0') return 0;
 	return 1;
 }
@@ -121,7 +287,948 @@ bool parse_value64(char *data, uint64_t *value)
 {
 	char *end;
 
-	*value = strtol(data, &end, 0);
+	*value = strtoull(data, &end, 0);
 	if (*end != '\0') return 0;
 	return 1;
 }
+
+/**
+ * parse_hex_string - gets up to max_len bytes from a hexadecimal string
+ */
+bool parse_hex_string(char *data, uint8_t *buf, size_t max_len, size_t *len)
+{
+	char byte[3] = { 0 };
+	char *end;
+	size_t i;
+
+	if (strncmp(data, "0x", 2) == 0 || strncmp(data, "0X", 2) == 0)
+		data += 2;
+	if (strlen(data) % 2 != 0 || strlen(data) / 2 > max_len)
+		return 0;
+
+	for (i = 0; data[2 * i] != '\0'; i++) {
+		byte[0] = data[2 * i];
+		byte[1] = data[2 * i + 1];
+		buf[i] = (uint8_t)strtoul(byte, &end, 16);
+		if (*end != '\0') return 0;
+	}
+	*len = i;
+	return 1;
+}
+
+/**
+ * parse_hex_bytes - gets exactly len bytes from a hexadecimal string
+ */
+bool parse_hex_bytes(char *data, uint8_t *buf, size_t len)
+{
+	size_t parsed;
+
+	if (!parse_hex_string(data, buf, len, &parsed))
+		return 0;
+	return parsed == len;
+}
+
+/**
+ * run_digest - digest an address range in the TA and optionally compare it
+ *
+ * The CRC32C is printed (and compared) as a 32-bit value; SHA-256 as the
+ * digest byte string. Returns 0 on success/match, 1 on error or mismatch.
+ */
+int run_digest(int argc, char *argv[], enum adimem_digest_algo algo)
+{
+	adimem_session_t session;
+	uint64_t address, length;
+	uint8_t digest[ADIMEM_DIGEST_MAX_LEN];
+	uint8_t expected[ADIMEM_DIGEST_MAX_LEN];
+	size_t digest_len = 0;
+	size_t expected_len = (algo == ADIMEM_DIGEST_CRC32C) ? ADIMEM_CRC32C_LEN : ADIMEM_SHA256_LEN;
+	uint32_t crc;
+	TEEC_Result res;
+
+	if (argc < 4 || argc > 5) {
+		printf(HELP, argv[0]);
+		return 1;
+	}
+
+	if (!parse_value64(argv[ARG_RANGE_ADDR], &address)) {
+		printf("Invalid address '%s'.\n", argv[ARG_RANGE_ADDR]);
+		return 1;
+	}
+
+	if (!parse_value64(argv[ARG_RANGE_LENGTH], &length) || length == 0) {
+		printf("Invalid length '%s'.\n", argv[ARG_RANGE_LENGTH]);
+		return 1;
+	}
+
+	if (length % (DIGEST_SIZE / 8) != 0) {
+		printf("Length must be a multiple of the access size.\n");
+		return 1;
+	}
+
+	if (argc > 4) {
+		/* CRC32C may be given as a plain number, e.g. 0x1234 */
+		if (algo == ADIMEM_DIGEST_CRC32C) {
+			if (!parse_value32(argv[ARG_RANGE_EXPECTED], &crc)) {
+				printf("Invalid expected CRC32C '%s'.\n", argv[ARG_RANGE_EXPECTED]);
+				return 1;
+			}
+			memcpy(expected, &crc, sizeof(crc));
+		} else if (!parse_hex_bytes(argv[ARG_RANGE_EXPECTED], expected, expected_len)) {
+			printf("Invalid expected SHA-256 '%s'.\n", argv[ARG_RANGE_EXPECTED]);
+			return 1;
+		}
+	}
+
+	if (adimem_open_session(&session) != TEEC_SUCCESS)
+		return 1;
+	res = adi_digest_memory(&session, address, length, DIGEST_SIZE, algo, digest, &digest_len);
+	adimem_close_session(&session);
+
+	if (res != TEEC_SUCCESS)
+		return 1;
+	if (digest_len != expected_len) {
+		printf("Unexpected digest length %zu.\n", digest_len);
+		return 1;
+	}
+
+	/* TA returns the CRC32C as a native endian 32-bit value */
+	if (algo == ADIMEM_DIGEST_CRC32C) {
+		memcpy(&crc, digest, sizeof(crc));
+		printf("0x%08x", crc);
+	} else {
+		for (size_t i = 0; i < digest_len; i++)
+			printf("%02x", digest[i]);
+	}
+
+	if (argc > 4) {
+		if (memcmp(digest, expected, expected_len) != 0) {
+			printf(" MISMATCH\n");
+			return 1;
+		}
+		printf(" OK\n");
+		return 0;
+	}
+
+	printf("\n");
+	return 0;
+}
+
+/**
+ * elapsed_seconds - time since start, from the monotonic clock
+ */
+static double elapsed_seconds(const struct timespec *start)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+/**
+ * throughput_mib - MiB/s for length bytes handled in secs
+ */
+static double throughput_mib(uint64_t length, double secs)
+{
+	return (secs > 0) ? (length / (1024.0 * 1024.0)) / secs : 0;
+}
+
+/**
+ * run_fill - fill an address range with a fixed value inside the TA
+ */
+int run_fill(int argc, char *argv[])
+{
+	adimem_session_t session;
+	uint64_t address, length, value;
+	uint64_t size = 32;
+	TEEC_Result res;
+
+	if (argc < 5 || argc > 6) {
+		printf(HELP, argv[0]);
+		return 1;
+	}
+
+	if (!parse_value64(argv[ARG_RANGE_ADDR], &address)) {
+		printf("Invalid address '%s'.\n", argv[ARG_RANGE_ADDR]);
+		return 1;
+	}
+
+	if (!parse_value64(argv[ARG_RANGE_LENGTH], &length) || length == 0) {
+		printf("Invalid length '%s'.\n", argv[ARG_RANGE_LENGTH]);
+		return 1;
+	}
+
+	if (argc > 5 && !parse_size(argv[ARG_RANGE_FILL_SIZE], &size)) {
+		printf("Invalid size '%s'.\n", argv[ARG_RANGE_FILL_SIZE]);
+		return 1;
+	}
+
+	if (!parse_value64(argv[ARG_RANGE_VALUE], &value) || (size < 64 && (value >> size) != 0)) {
+		printf("Invalid value '%s'.\n", argv[ARG_RANGE_VALUE]);
+		return 1;
+	}
+
+	if (length % (size / 8) != 0) {
+		printf("Length must be a multiple of the access size.\n");
+		return 1;
+	}
+
+	if (adimem_open_session(&session) != TEEC_SUCCESS)
+		return 1;
+	res = adi_fill_memory(&session, address, length, size, ADIMEM_PATTERN_FIXED, value);
+	adimem_close_session(&session);
+
+	return (res == TEEC_SUCCESS) ? 0 : 1;
+}
+
+/**
+ * run_memtest - run the memtest pattern suite over an address range
+ *
+ * Each pattern is written and verified entirely inside the TA; only the
+ * mismatch count and the first failing addresses come back. Returns 0 if
+ * every pattern verified cleanly.
+ */
+int run_memtest(int argc, char *argv[])
+{
+	adimem_session_t session;
+	uint64_t address, length;
+	uint64_t size = 32;
+	uint64_t failures[MEMTEST_MAX_FAILURES];
+	uint32_t mismatches, num_failures;
+	uint32_t total_mismatches = 0;
+	struct timespec start;
+	double fill_secs, verify_secs;
+	TEEC_Result res = TEEC_SUCCESS;
+
+	if (argc < 4 || argc > 5) {
+		printf(HELP, argv[0]);
+		return 1;
+	}
+
+	if (!parse_value64(argv[ARG_RANGE_ADDR], &address)) {
+		printf("Invalid address '%s'.\n", argv[ARG_RANGE_ADDR]);
+		return 1;
+	}
+
+	if (!parse_value64(argv[ARG_RANGE_LENGTH], &length) || length == 0) {
+		printf("Invalid length '%s'.\n", argv[ARG_RANGE_LENGTH]);
+		return 1;
+	}
+
+	if (argc > 4) {
+		if (!parse_value64(argv[ARG_RANGE_SIZE], &size) ||
+		    (size != 8 && size != 16 && size != 32 && size != 64)) {
+			printf("Invalid size '%s'.\n", argv[ARG_RANGE_SIZE]);
+			return 1;
+		}
+	}
+
+	if (length % (size / 8) != 0) {
+		printf("Length must be a multiple of the access size.\n");
+		return 1;
+	}
+
+	if (adimem_open_session(&session) != TEEC_SUCCESS)
+		return 1;
+
+	printf("%-14s %12s %12s %10s\n", "pattern", "fill MiB/s", "verify MiB/s", "mismatches");
+	for (size_t i = 0; i < sizeof(memtest_suite) / sizeof(memtest_suite[0]); i++) {
+		const struct memtest_step *step = &memtest_suite[i];
+
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		res = adi_fill_memory(&session, address, length, size, step->pattern, step->value);
+		if (res != TEEC_SUCCESS)
+			break;
+		fill_secs = elapsed_seconds(&start);
+
+		num_failures = MEMTEST_MAX_FAILURES;
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		res = adi_verify_memory(&session, address, length, size, step->pattern, step->value,
+					&mismatches, failures, &num_failures);
+		if (res != TEEC_SUCCESS)
+			break;
+		verify_secs = elapsed_seconds(&start);
+
+		printf("%-14s %12.1f %12.1f %10u\n", step->name, throughput_mib(length, fill_secs),
+		       throughput_mib(length, verify_secs), mismatches);
+		for (uint32_t f = 0; f < num_failures; f++)
+			printf("  failed at 0x%llx\n", (unsigned long long)failures[f]);
+
+		total_mismatches += mismatches;
+	}
+
+	adimem_close_session(&session);
+
+	if (res != TEEC_SUCCESS)
+		return 1;
+	return (total_mismatches == 0) ? 0 : 1;
+}
+
+/**
+ * run_search - find a masked byte pattern in an address range inside the TA
+ *
+ * Only the match offsets are returned by the TA; matches are printed as
+ * absolute addresses.
+ */
+int run_search(int argc, char *argv[])
+{
+	adimem_session_t session;
+	uint64_t address, length;
+	uint8_t pattern[ADIMEM_SEARCH_MAX_LEN];
+	uint8_t mask[ADIMEM_SEARCH_MAX_LEN];
+	size_t pattern_len, mask_len;
+	uint64_t *offsets;
+	uint32_t hits, num_offsets = SEARCH_MAX_HITS;
+	TEEC_Result res;
+
+	if (argc < 5 || argc > 6) {
+		printf(HELP, argv[0]);
+		return 1;
+	}
+
+	if (!parse_value64(argv[ARG_RANGE_ADDR], &address)) {
+		printf("Invalid address '%s'.\n", argv[ARG_RANGE_ADDR]);
+		return 1;
+	}
+
+	if (!parse_value64(argv[ARG_RANGE_LENGTH], &length) || length == 0) {
+		printf("Invalid length '%s'.\n", argv[ARG_RANGE_LENGTH]);
+		return 1;
+	}
+
+	if (!parse_hex_string(argv[ARG_RANGE_PATTERN], pattern, sizeof(pattern), &pattern_len) ||
+	    pattern_len == 0) {
+		printf("Invalid pattern '%s'.\n", argv[ARG_RANGE_PATTERN]);
+		return 1;
+	}
+
+	if (argc > 5) {
+		if (!parse_hex_string(argv[ARG_RANGE_MASK], mask, sizeof(mask), &mask_len) ||
+		    mask_len != pattern_len) {
+			printf("Invalid mask '%s'.\n", argv[ARG_RANGE_MASK]);
+			return 1;
+		}
+	}
+
+	offsets = malloc(SEARCH_MAX_HITS * sizeof(uint64_t));
+	if (offsets == NULL)
+		return 1;
+
+	if (adimem_open_session(&session) != TEEC_SUCCESS) {
+		free(offsets);
+		return 1;
+	}
+	res = adi_search_memory(&session, address, length, 32, pattern, (argc > 5) ? mask : NULL,
+				pattern_len, 1, &hits, offsets, &num_offsets);
+	adimem_close_session(&session);
+
+	if (res == TEEC_SUCCESS) {
+		for (uint32_t i = 0; i < num_offsets; i++)
+			printf("0x%llx\n", (unsigned long long)(address + offsets[i]));
+		if (hits > num_offsets)
+			printf("... %u more matches not shown\n", hits - num_offsets);
+	}
+
+	free(offsets);
+	return (res == TEEC_SUCCESS) ? 0 : 1;
+}
+
+/**
+ * run_dump - read an address range with bulk accesses and write it to a file
+ */
+int run_dump(int argc, char *argv[])
+{
+	adimem_session_t session;
+	uint64_t address, length;
+	uint8_t *data;
+	FILE *fp;
+	TEEC_Result res;
+
+	if (argc != 5) {
+		printf(HELP, argv[0]);
+		return 1;
+	}
+
+	if (!parse_value64(argv[ARG_RANGE_ADDR], &address)) {
+		printf("Invalid address '%s'.\n", argv[ARG_RANGE_ADDR]);
+		return 1;
+	}
+
+	if (!parse_value64(argv[ARG_RANGE_LENGTH], &length) || length == 0 || length > SIZE_MAX) {
+		printf("Invalid length '%s'.\n", argv[ARG_RANGE_LENGTH]);
+		return 1;
+	}
+
+	data = malloc(length);
+	if (data == NULL) {
+		printf("Unable to allocate %llu bytes\n", (unsigned long long)length);
+		return 1;
+	}
+
+	if (adimem_open_session(&session) != TEEC_SUCCESS) {
+		free(data);
+		return 1;
+	}
+	res = adi_read_memory_bulk(&session, address, length, 64, data);
+	adimem_close_session(&session);
+
+	if (res != TEEC_SUCCESS) {
+		free(data);
+		return 1;
+	}
+
+	fp = fopen(argv[ARG_RANGE_FILE], "wb");
+	if (fp == NULL) {
+		printf("Unable to open file %s\n", argv[ARG_RANGE_FILE]);
+		free(data);
+		return 1;
+	}
+	if (fwrite(data, 1, length, fp) != length) {
+		printf("Unable to write to file %s\n", argv[ARG_RANGE_FILE]);
+		fclose(fp);
+		free(data);
+		return 1;
+	}
+	free(data);
+
+	if (fclose(fp) != 0) {
+		printf("Unable to close file %s\n", argv[ARG_RANGE_FILE]);
+		return 1;
+	}
+
+	return 0;
+}
+
+/**
+ * run_hexdump - read an address range and print it as hex
+ *
+ * The range is read HEX_READ_CHUNK bytes at a time with accesses of the
+ * word width, so only one chunk is resident however long the range.
+ */
+int run_hexdump(int argc, char *argv[])
+{
+	adimem_session_t session;
+	hexdump_format_t fmt;
+	hexdump_t hd;
+	uint64_t address, length, n;
+	uint8_t *data;
+	TEEC_Result res = TEEC_SUCCESS;
+
+	if (argc != 4 && argc != 5) {
+		printf(HELP, argv[0]);
+		return 1;
+	}
+
+	if (!parse_value64(argv[ARG_RANGE_ADDR], &address)) {
+		printf("Invalid address '%s'.\n", argv[ARG_RANGE_ADDR]);
+		return 1;
+	}
+
+	if (!parse_value64(argv[ARG_RANGE_LENGTH], &length) || length == 0) {
+		printf("Invalid length '%s'.\n", argv[ARG_RANGE_LENGTH]);
+		return 1;
+	}
+
+	hexdump_format_init(&fmt);
+	if (argc == 5 && !hexdump_parse_format(argv[ARG_RANGE_FORMAT], &fmt)) {
+		printf("Invalid format '%s'.\n", argv[ARG_RANGE_FORMAT]);
+		return 1;
+	}
+	fmt.base = address;
+
+	data = malloc(HEX_READ_CHUNK);
+	if (data == NULL || !hexdump_init(&hd, &fmt, STDOUT_FILENO)) {
+		printf("Unable to allocate hexdump buffers\n");
+		free(data);
+		return 1;
+	}
+
+	if (adimem_open_session(&session) != TEEC_SUCCESS) {
+		hexdump_finish(&hd);
+		free(data);
+		return 1;
+	}
+	while (length > 0) {
+		n = (length < HEX_READ_CHUNK) ? length : HEX_READ_CHUNK;
+		res = adi_read_memory_bulk(&session, address, n, fmt.width * 8, data);
+		if (res != TEEC_SUCCESS || !hexdump_write(&hd, data, n))
+			break;
+		address += n;
+		length -= n;
+	}
+	adimem_close_session(&session);
+
+	if (!hexdump_finish(&hd) && res == TEEC_SUCCESS) {
+		printf("Unable to write hexdump output\n");
+		res = TEEC_ERROR_GENERIC;
+	}
+	free(data);
+
+	return (res == TEEC_SUCCESS && length == 0) ? 0 : 1;
+}
+
+/**
+ * run_symbolic - read or write a register or register field by name
+ */
+int run_symbolic(int argc, char *argv[])
+{
+	regmap_t map;
+	const regmap_reg_t *reg;
+	const regmap_field_t *field;
+	adimem_session_t session;
+	const char *path = getenv(REGMAP_ENV);
+	uint64_t value = 0, data = 0;
+	int ret = 1;
+
+	if (argc > 3) {
+		printf(HELP, argv[0]);
+		return 1;
+	}
+
+	if (path == NULL)
+		path = REGMAP_DEFAULT_PATH;
+	if (!regmap_open(&map, path)) {
+		printf("Invalid address '%s' (no register map at %s).\n", argv[ARG_NAME], path);
+		return 1;
+	}
+
+	if (!regmap_resolve(&map, argv[ARG_NAME], &reg, &field)) {
+		printf("Unknown register '%s'.\n", argv[ARG_NAME]);
+		goto end;
+	}
+
+	if (argc > 2 && !parse_value64(argv[ARG_NAME_DATA], &data)) {
+		printf("Invalid value '%s'.\n", argv[ARG_NAME_DATA]);
+		goto end;
+	}
+
+	if (adimem_open_session(&session) != TEEC_SUCCESS)
+		goto end;
+	session.cache = cache;
+
+	/* Whole register write needs no read */
+	if (argc > 2 && field == NULL) {
+		if (adi_write_register(&session, reg->address, reg->size, data) == TEEC_SUCCESS)
+			ret = 0;
+		goto close;
+	}
+
+	if (adi_read_register(&session, reg->address, reg->size, &value) != TEEC_SUCCESS)
+		goto close;
+
+	/* Field write: read-modify-write */
+	if (argc > 2) {
+		value = regmap_field_set(field, value, data);
+		if (adi_write_register(&session, reg->address, reg->size, value) == TEEC_SUCCESS)
+			ret = 0;
+		goto close;
+	}
+
+	if (field != NULL) {
+		printf("0x%llx\n", (unsigned long long)regmap_field_get(field, value));
+	} else {
+		printf("0x%llx\n", (unsigned long long)value);
+		for (uint32_t i = 0; i < reg->num_fields && reg->first_field + i < map.hdr->num_fields; i++) {
+			const regmap_field_t *f = &map.fields[reg->first_field + i];
+
+			printf("  %-24s [%u:%u] 0x%llx\n", regmap_name(&map, f->name),
+			       f->lsb + f->width - 1, f->lsb, (unsigned long long)regmap_field_get(f, value));
+		}
+	}
+	ret = 0;
+
+close:
+	adimem_close_session(&session);
+	cache_report();
+end:
+	regmap_close(&map);
+	return ret;
+}
+
+/**
+ * run_replay - re-execute a recorded journal
+ */
+int run_replay(int argc, char *argv[])
+{
+	uint32_t flags = 0;
+	uint32_t mismatches;
+	TEEC_Result res;
+
+	if (argc < 3) {
+		printf(HELP, argv[0]);
+		return 1;
+	}
+
+	for (int i = 3; i < argc; i++) {
+		if (strcmp(argv[i], "--timed") == 0) {
+			flags |= ADIMEM_REPLAY_TIMED;
+		} else if (strcmp(argv[i], "--verify") == 0) {
+			flags |= ADIMEM_REPLAY_VERIFY;
+		} else {
+			printf(HELP, argv[0]);
+			return 1;
+		}
+	}
+
+	res = adimem_replay(argv[ARG_RANGE_ADDR], flags, cache, &mismatches);
+	cache_report();
+	if (res != TEEC_SUCCESS)
+		return 1;
+
+	if (flags & ADIMEM_REPLAY_VERIFY)
+		printf("%u mismatches\n", mismatches);
+
+	return (mismatches == 0) ? 0 : 1;
+}
+
+/**
+ * parse_size - gets an access width in bits: 8, 16, 32 or 64
+ */
+bool parse_size(char *data, uint64_t *size)
+{
+	if (!parse_value64(data, size))
+		return 0;
+	return *size == 8 || *size == 16 || *size == 32 || *size == 64;
+}
+
+/**
+ * run_snapshot - capture a region into a snapshot file with bulk reads
+ */
+int run_snapshot(int argc, char *argv[])
+{
+	adimem_session_t session;
+	uint64_t address, length;
+	uint64_t size = 32;
+	bool ok;
+
+	if (argc < 5 || argc > 6) {
+		printf(HELP, argv[0]);
+		return 1;
+	}
+
+	if (!parse_value64(argv[ARG_RANGE_ADDR], &address)) {
+		printf("Invalid address '%s'.\n", argv[ARG_RANGE_ADDR]);
+		return 1;
+	}
+
+	if (!parse_value64(argv[ARG_RANGE_LENGTH], &length) || length == 0) {
+		printf("Invalid length '%s'.\n", argv[ARG_RANGE_LENGTH]);
+		return 1;
+	}
+
+	if (argc > 5 && !parse_size(argv[ARG_RANGE_FILE_SIZE], &size)) {
+		printf("Invalid size '%s'.\n", argv[ARG_RANGE_FILE_SIZE]);
+		return 1;
+	}
+
+	if (adimem_open_session(&session) != TEEC_SUCCESS)
+		return 1;
+	ok = snapshot_capture(&session, address, length, size, argv[ARG_RANGE_FILE]);
+	adimem_close_session(&session);
+
+	return ok ? 0 : 1;
+}
+
+/**
+ * run_diff - print the words that changed between two snapshots, or a snapshot and live memory
+ *
+ * Returns 0 if the regions are identical, 1 if they differ or on error.
+ */
+int run_diff(int argc, char *argv[])
+{
+	adimem_session_t session;
+	snapshot_t old, new;
+	const uint8_t *new_data;
+	uint8_t *live = NULL;
+	uint64_t address, length;
+	uint64_t size;
+	uint64_t changed;
+	bool is_live;
+
+	if (argc < 4 || argc > 5) {
+		printf(HELP, argv[0]);
+		return 1;
+	}
+
+	if (!snapshot_open(&old, argv[ARG_DIFF_OLD]))
+		return 1;
+	size = old.hdr->size;
+	if (argc > 4 && !parse_size(argv[ARG_DIFF_SIZE], &size)) {
+		printf("Invalid size '%s'.\n", argv[ARG_DIFF_SIZE]);
+		snapshot_close(&old);
+		return 1;
+	}
+	address = old.hdr->address;
+	length = old.hdr->length;
+
+	is_live = strcmp(argv[ARG_DIFF_NEW], "live") == 0;
+	memset(&new, 0, sizeof(new));
+	if (is_live) {
+		live = malloc(length);
+		if (live == NULL || adimem_open_session(&session) != TEEC_SUCCESS) {
+			free(live);
+			snapshot_close(&old);
+			return 1;
+		}
+		if (adi_read_memory_bulk(&session, address, length, old.hdr->size, live) != TEEC_SUCCESS) {
+			adimem_close_session(&session);
+			free(live);
+			snapshot_close(&old);
+			return 1;
+		}
+		adimem_close_session(&session);
+		new_data = live;
+	} else {
+		if (!snapshot_open(&new, argv[ARG_DIFF_NEW])) {
+			snapshot_close(&old);
+			return 1;
+		}
+		if (new.hdr->address != address || new.hdr->length != length) {
+			printf("Snapshots cover different regions.\n");
+			snapshot_close(&new);
+			snapshot_close(&old);
+			return 1;
+		}
+		new_data = new.data;
+	}
+
+	changed = snapshot_diff(address, old.data, new_data, length, size);
+
+	free(live);
+	snapshot_close(&new);
+	snapshot_close(&old);
+
+	return (changed == 0) ? 0 : 1;
+}
+
+/**
+ * is_address_list - true if the arguments are a list of addresses and ranges
+ *
+ * A list starts with --list or -s, or has more than three arguments or a
+ * range. Up to three plain numbers are always the single access form
+ * "address [size [data]]", so a list of those never turns into a write.
+ */
+bool is_address_list(int argc, char *argv[])
+{
+	if (strcmp(argv[ARG_ADDR], "--list") == 0 || strcmp(argv[ARG_ADDR], "-s") == 0 || argc > 4)
+		return 1;
+
+	for (int i = ARG_ADDR; i < argc; i++)
+		if (strchr(argv[i] + 1, '-') != NULL || strchr(argv[i], '/') != NULL)
+			return 1;
+
+	return 0;
+}
+
+/**
+ * parse_range - gets start, end and step from "start-end[/step]"
+ */
+static bool parse_range(char *data, uint64_t *start, uint64_t *end, uint64_t *step)
+{
+	char *p;
+
+	*start = strtoull(data, &p, 0);
+	if (p == data || *p != '-')
+		return 0;
+	data = p + 1;
+	*end = strtoull(data, &p, 0);
+	if (p == data || *end < *start)
+		return 0;
+	if (*p == '/') {
+		data = p + 1;
+		*step = strtoull(data, &p, 0);
+		if (p == data || *step == 0)
+			return 0;
+	}
+	return *p == '\0';
+}
+
+/**
+ * add_access - append one read to a growing access list
+ */
+static bool add_access(adimem_access_t **accesses, uint32_t *count, uint32_t *capacity,
+		       uint64_t address, uint64_t size)
+{
+	adimem_access_t *p;
+
+	if (*count == *capacity) {
+		if (*capacity >= UINT32_MAX / 2)
+			return 0;
+		*capacity = *capacity ? *capacity * 2 : ADIMEM_BATCH_MAX;
+		p = realloc(*accesses, *capacity * sizeof(adimem_access_t));
+		if (p == NULL)
+			return 0;
+		*accesses = p;
+	}
+
+	memset(&(*accesses)[*count], 0, sizeof(adimem_access_t));
+	(*accesses)[*count].address = address;
+	(*accesses)[*count].cmd = TA_ADIMEM_CMD_READ;
+	(*accesses)[*count].size = size;
+	(*count)++;
+	return 1;
+}
+
+/**
+ * run_list - read a list of addresses and ranges over one session
+ *
+ * The reads go to the TA in TA_ADIMEM_CMD_BATCH invokes, so the cost is one
+ * session and a few invokes however long the list. Output is one
+ * "address value" line per read, in list order.
+ */
+int run_list(int argc, char *argv[])
+{
+	adimem_session_t session;
+	adimem_access_t *accesses = NULL;
+	uint32_t count = 0, capacity = 0, completed = 0;
+	uint64_t size = 32;
+	uint64_t address, start, end, step;
+	int arg = ARG_ADDR;
+	TEEC_Result res;
+
+	if (strcmp(argv[arg], "--list") == 0)
+		arg++;
+
+	if (arg < argc && strcmp(argv[arg], "-s") == 0) {
+		if (arg + 1 >= argc || !parse_size(argv[arg + 1], &size)) {
+			printf("Invalid size '%s'.\n", (arg + 1 < argc) ? argv[arg + 1] : "");
+			return 1;
+		}
+		arg += 2;
+	}
+
+	for (; arg < argc; arg++) {
+		if (parse_value64(argv[arg], &address)) {
+			if (!add_access(&accesses, &count, &capacity, address, size))
+				goto nomem;
+			continue;
+		}
+
+		step = size / 8;
+		if (!parse_range(argv[arg], &start, &end, &step)) {
+			printf("Invalid address '%s'.\n", argv[arg]);
+			free(accesses);
+			return 1;
+		}
+		for (address = start; address < end; address += step) {
+			if (!add_access(&accesses, &count, &capacity, address, size))
+				goto nomem;
+			if (address + step < address)
+				break;
+		}
+	}
+
+	if (count == 0) {
+		printf(HELP, argv[0]);
+		free(accesses);
+		return 1;
+	}
+
+	if (adimem_open_session(&session) != TEEC_SUCCESS) {
+		free(accesses);
+		return 1;
+	}
+	session.cache = cache;
+	res = adi_access_batch(&session, accesses, count, &completed);
+	adimem_close_session(&session);
+	cache_report();
+
+	for (uint32_t i = 0; i < completed; i++)
+		printf("0x%08llx  0x%0*llx\n", (unsigned long long)accesses[i].address, (int)(size / 4),
+		       (unsigned long long)accesses[i].value);
+	if (res != TEEC_SUCCESS && completed < count)
+		printf("0x%08llx  read failed with code 0x%x\n", (unsigned long long)accesses[completed].address,
+		       accesses[completed].result);
+
+	free(accesses);
+	return (res == TEEC_SUCCESS) ? 0 : 1;
+
+nomem:
+	printf("Too many addresses.\n");
+	free(accesses);
+	return 1;
+}
+
+/**
+ * cache_start - set up the register cache from "policy@start+length,..."
+ *
+ * policy is a time to live in ms, 0 to keep reads until written, or never.
+ * Ranges are matched in order, so list never ranges (status, FIFO) before
+ * the block that holds them. Addresses outside every range are not cached.
+ */
+bool cache_start(char *spec)
+{
+	enum adimem_cache_policy policy;
+	unsigned long ttl_ms;
+	uint64_t start, length;
+	char *p = spec;
+	char *end;
+
+	if (!adimem_cache_init(&register_cache, CACHE_SETS)) {
+		printf("Unable to allocate the register cache.\n");
+		return 0;
+	}
+
+	for (;;) {
+		ttl_ms = 0;
+		if (strncmp(p, "never@", 6) == 0) {
+			policy = ADIMEM_CACHE_NEVER;
+			p += 5;
+		} else {
+			ttl_ms = strtoul(p, &end, 0);
+			if (end == p || *p == '-' || ttl_ms > UINT32_MAX)
+				goto invalid;
+			policy = (ttl_ms != 0) ? ADIMEM_CACHE_TTL : ADIMEM_CACHE_UNTIL_WRITE;
+			p = end;
+		}
+		if (*p++ != '@')
+			goto invalid;
+
+		start = strtoull(p, &end, 0);
+		if (end == p || *p == '-' || *end != '+')
+			goto invalid;
+		p = end + 1;
+		length = strtoull(p, &end, 0);
+		if (end == p || *p == '-')
+			goto invalid;
+		p = end;
+
+		if (!adimem_cache_add_range(&register_cache, start, length, policy, ttl_ms))
+			goto invalid;
+		if (*p == '\0')
+			break;
+		if (*p++ != ',')
+			goto invalid;
+	}
+
+	cache = &register_cache;
+	return 1;
+
+invalid:
+	printf("Invalid %s '%s'.\n", ADIMEM_CACHE_ENV, spec);
+	adimem_cache_free(&register_cache);
+	return 0;
+}
+
+/**
+ * cache_stop - release the register cache
+ */
+void cache_stop(void)
+{
+	if (cache == NULL)
+		return;
+	adimem_cache_free(cache);
+	cache = NULL;
+}
+
+/**
+ * cache_report - print the register cache counters on stderr
+ *
+ * stderr keeps the counters out of the values printed on stdout.
+ */
+void cache_report(void)
+{
+	if (cache == NULL)
+		return;
+	fprintf(stderr, "cache: %llu hits, %llu misses, %llu invalidations\n", (unsigned long long)cache->hits,
+		(unsigned long long)cache->misses, (unsigned long long)cache->invalidations);
+}
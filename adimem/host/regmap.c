@@ -0,0 +1,235 @@
+/*
+ * Copyright (c) 2026, Analog Devices Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "regmap.h"
+
+/**
+ * regmap_hash - FNV-1a of name, seeded, with a final avalanche
+ */
+uint32_t regmap_hash(const char *name, size_t len, uint32_t seed)
+{
+	uint32_t h = 0x811c9dc5 ^ (seed * 0x9e3779b9);
+
+	for (size_t i = 0; i < len; i++) {
+		h ^= (uint8_t)name[i];
+		h *= 0x01000193;
+	}
+
+	h ^= h >> 16;
+	h *= 0x85ebca6b;
+	h ^= h >> 13;
+	h *= 0xc2b2ae35;
+	h ^= h >> 16;
+
+	return h;
+}
+
+/**
+ * regmap_section_ok - check a table lies within the mapped file
+ */
+static bool regmap_section_ok(size_t len, uint32_t offset, uint64_t count, size_t elem)
+{
+	return offset <= len && count * elem <= len - offset && offset % sizeof(uint32_t) == 0;
+}
+
+/**
+ * regmap_open - map a compiled register map
+ *
+ * Only the header is validated; tables are used in place and every index
+ * taken from the file is bounds checked when it is followed.
+ */
+bool regmap_open(regmap_t *map, const char *path)
+{
+	const regmap_header_t *hdr;
+	struct stat st;
+	void *base;
+	int fd;
+
+	memset(map, 0, sizeof(*map));
+
+	fd = open(path, O_RDONLY);
+	if (fd < 0)
+		return false;
+
+	if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(regmap_header_t)) {
+		close(fd);
+		return false;
+	}
+
+	base = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (base == MAP_FAILED)
+		return false;
+
+	map->base = base;
+	map->len = st.st_size;
+	hdr = base;
+
+	if (hdr->magic != REGMAP_MAGIC || hdr->version != REGMAP_VERSION ||
+	    (hdr->num_regs != 0 && hdr->num_buckets == 0) ||
+	    !regmap_section_ok(map->len, hdr->disp_offset, hdr->num_buckets, sizeof(uint32_t)) ||
+	    !regmap_section_ok(map->len, hdr->reg_offset, hdr->num_regs, sizeof(regmap_reg_t)) ||
+	    !regmap_section_ok(map->len, hdr->field_offset, hdr->num_fields, sizeof(regmap_field_t)) ||
+	    !regmap_section_ok(map->len, hdr->string_offset, hdr->string_size, 1) ||
+	    hdr->string_size == 0 || map->base[hdr->string_offset + hdr->string_size - 1] != '\0') {
+		regmap_close(map);
+		return false;
+	}
+
+	map->hdr = hdr;
+	map->disp = (const uint32_t *)(map->base + hdr->disp_offset);
+	map->regs = (const regmap_reg_t *)(map->base + hdr->reg_offset);
+	map->fields = (const regmap_field_t *)(map->base + hdr->field_offset);
+	map->strings = (const char *)(map->base + hdr->string_offset);
+
+	return true;
+}
+
+/**
+ * regmap_close - unmap a register map
+ */
+void regmap_close(regmap_t *map)
+{
+	if (map->base != NULL)
+		munmap((void *)map->base, map->len);
+	memset(map, 0, sizeof(*map));
+}
+
+/**
+ * regmap_name - name at a string table offset, "" if out of bounds
+ */
+const char *regmap_name(const regmap_t *map, uint32_t offset)
+{
+	if (offset >= map->hdr->string_size)
+		return "";
+	return map->strings + offset;
+}
+
+/**
+ * regmap_find_reg - O(1) lookup of a register by its first len characters of name
+ */
+const regmap_reg_t *regmap_find_reg(const regmap_t *map, const char *name, size_t len)
+{
+	const regmap_reg_t *reg;
+	const char *reg_name;
+	uint32_t bucket, slot;
+
+	if (map->hdr->num_regs == 0)
+		return NULL;
+
+	bucket = regmap_hash(name, len, 0) % map->hdr->num_buckets;
+	slot = regmap_hash(name, len, map->disp[bucket]) % map->hdr->num_regs;
+	reg = &map->regs[slot];
+
+	reg_name = regmap_name(map, reg->name);
+	if (strncmp(reg_name, name, len) != 0 || reg_name[len] != '\0')
+		return NULL;
+
+	return reg;
+}
+
+/**
+ * regmap_find_field - look up a field of a register by name
+ */
+const regmap_field_t *regmap_find_field(const regmap_t *map, const regmap_reg_t *reg, const char *name)
+{
+	if ((uint64_t)reg->first_field + reg->num_fields > map->hdr->num_fields)
+		return NULL;
+
+	for (uint32_t i = 0; i < reg->num_fields; i++) {
+		const regmap_field_t *field = &map->fields[reg->first_field + i];
+
+		if (strcmp(regmap_name(map, field->name), name) == 0)
+			return field;
+	}
+
+	return NULL;
+}
+
+/**
+ * regmap_resolve - resolve "BLOCK.REG" or "BLOCK.REG.FIELD"
+ *
+ * field is set to NULL when name is a register.
+ */
+bool regmap_resolve(const regmap_t *map, const char *name, const regmap_reg_t **reg,
+		    const regmap_field_t **field)
+{
+	const char *dot;
+
+	*field = NULL;
+	*reg = regmap_find_reg(map, name, strlen(name));
+	if (*reg != NULL)
+		return true;
+
+	dot = strrchr(name, '.');
+	if (dot == NULL)
+		return false;
+
+	*reg = regmap_find_reg(map, name, dot - name);
+	if (*reg == NULL)
+		return false;
+
+	*field = regmap_find_field(map, *reg, dot + 1);
+	return *field != NULL;
+}
+
+/**
+ * regmap_field_mask - mask of a field, right aligned
+ */
+static uint64_t regmap_field_mask(const regmap_field_t *field)
+{
+	return (field->width >= 64) ? ~0ULL : ((1ULL << field->width) - 1);
+}
+
+/**
+ * regmap_field_get - extract a field from a register value
+ */
+uint64_t regmap_field_get(const regmap_field_t *field, uint64_t value)
+{
+	if (field->lsb >= 64)
+		return 0;
+	return (value >> field->lsb) & regmap_field_mask(field);
+}
+
+/**
+ * regmap_field_set - insert field_value into a register value
+ */
+uint64_t regmap_field_set(const regmap_field_t *field, uint64_t value, uint64_t field_value)
+{
+	uint64_t mask;
+
+	if (field->lsb >= 64)
+		return value;
+	mask = regmap_field_mask(field) << field->lsb;
+	return (value & ~mask) | ((field_value << field->lsb) & mask);
+}
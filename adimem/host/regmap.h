@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2026, Analog Devices Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef REGMAP_H
+#define REGMAP_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Compiled register map
+ *
+ * The map is a single file that is mmap'd and used in place, so no parsing
+ * happens at startup. Layout (all offsets from the start of the file):
+ *
+ *   regmap_header_t
+ *   uint32_t       disp[num_buckets]    displacement seed per hash bucket
+ *   regmap_reg_t   regs[num_regs]       ordered by perfect hash slot
+ *   regmap_field_t fields[num_fields]   grouped per register
+ *   char           strings[]            NUL terminated names
+ *
+ * Register names ("BLOCK.REG") are looked up with a minimal perfect hash:
+ * slot = regmap_hash(name, disp[regmap_hash(name, 0) % num_buckets]) % num_regs.
+ * The name stored at the slot is compared to reject unknown names.
+ */
+#define REGMAP_MAGIC 0x504d5241         /* "ARMP" */
+#define REGMAP_VERSION 1
+#define REGMAP_DEFAULT_PATH "/etc/adimem/regmap.bin"
+#define REGMAP_ENV "ADIMEM_REGMAP"
+#define REGMAP_NAME_MAX 128
+
+typedef struct regmap_header {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t num_buckets;
+	uint32_t num_regs;
+	uint32_t num_fields;
+	uint32_t disp_offset;
+	uint32_t reg_offset;
+	uint32_t field_offset;
+	uint32_t string_offset;
+	uint32_t string_size;
+} regmap_header_t;
+
+typedef struct regmap_reg {
+	uint64_t address;
+	uint32_t name;                  /* Offset into strings */
+	uint32_t first_field;           /* Index into fields */
+	uint16_t num_fields;
+	uint16_t size;                  /* Access width in bits */
+	uint32_t reserved;
+} regmap_reg_t;
+
+typedef struct regmap_field {
+	uint32_t name;                  /* Offset into strings */
+	uint8_t lsb;
+	uint8_t width;
+	uint16_t reserved;
+} regmap_field_t;
+
+/* A register map mapped into memory */
+typedef struct regmap {
+	const uint8_t *base;
+	size_t len;
+	const regmap_header_t *hdr;
+	const uint32_t *disp;
+	const regmap_reg_t *regs;
+	const regmap_field_t *fields;
+	const char *strings;
+} regmap_t;
+
+uint32_t regmap_hash(const char *name, size_t len, uint32_t seed);
+
+bool regmap_open(regmap_t *map, const char *path);
+void regmap_close(regmap_t *map);
+
+const regmap_reg_t *regmap_find_reg(const regmap_t *map, const char *name, size_t len);
+const regmap_field_t *regmap_find_field(const regmap_t *map, const regmap_reg_t *reg, const char *name);
+bool regmap_resolve(const regmap_t *map, const char *name, const regmap_reg_t **reg,
+		    const regmap_field_t **field);
+const char *regmap_name(const regmap_t *map, uint32_t offset);
+
+uint64_t regmap_field_get(const regmap_field_t *field, uint64_t value);
+uint64_t regmap_field_set(const regmap_field_t *field, uint64_t value, uint64_t field_value);
+
+bool regmap_compile(const char *input, const char *output);
+
+#endif /* REGMAP_H */
@@ -0,0 +1,482 @@
+/*
+ * Copyright (c) 2026, Analog Devices Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "regmap.h"
+
+/* Displacement seeds tried per bucket before giving up */
+#define REGMAP_MAX_DISP (1 << 20)
+
+/*
+ * Text register map, one register per line followed by its fields,
+ * indented:
+ *
+ *   # comment
+ *   BLOCK.REG  address  [size]
+ *       FIELD  msb[:lsb]
+ */
+
+typedef struct src_reg {
+	char *name;
+	uint64_t address;
+	uint16_t size;
+	uint32_t first_field;
+	uint32_t num_fields;
+	uint32_t bucket;
+	uint32_t slot;
+} src_reg_t;
+
+typedef struct src_field {
+	char *name;
+	uint8_t lsb;
+	uint8_t width;
+} src_field_t;
+
+typedef struct src_map {
+	src_reg_t *regs;
+	size_t num_regs;
+	src_field_t *fields;
+	size_t num_fields;
+} src_map_t;
+
+/**
+ * grow - make room for one more element in a dynamic array
+ */
+static bool grow(void **array, size_t count, size_t elem)
+{
+	void *p;
+
+	/* Capacity doubles whenever count reaches a power of two */
+	if ((count & (count - 1)) != 0)
+		return true;
+
+	p = realloc(*array, (count ? count * 2 : 1) * elem);
+	if (p == NULL)
+		return false;
+	*array = p;
+	return true;
+}
+
+/**
+ * parse_number - gets the unsigned number at *p, decimal or 0x hexadecimal
+ *
+ * The number must end at white space or the end of the line. *p is moved
+ * past it.
+ */
+static bool parse_number(char **p, unsigned long long *value)
+{
+	char *end;
+
+	while (isspace((unsigned char)**p))
+		(*p)++;
+	if (!isdigit((unsigned char)**p))
+		return false;
+
+	*value = strtoull(*p, &end, 0);
+	if (*end != '\0' && !isspace((unsigned char)*end))
+		return false;
+	*p = end;
+	return true;
+}
+
+/**
+ * parse_line - add the register or field described by one line
+ */
+static bool parse_line(src_map_t *src, char *line, unsigned int lineno)
+{
+	char name[REGMAP_NAME_MAX];
+	unsigned long long address, size = 32;
+	unsigned int msb, lsb;
+	char *p;
+	int n;
+
+	if (isspace((unsigned char)line[0])) {
+		src_reg_t *reg;
+
+		if (src->num_regs == 0) {
+			printf("line %u: field outside of a register\n", lineno);
+			return false;
+		}
+		reg = &src->regs[src->num_regs - 1];
+
+		n = sscanf(line, " %127s %u:%u", name, &msb, &lsb);
+		if (n == 2)
+			lsb = msb;
+		if (n < 2 || lsb > msb || msb >= reg->size) {
+			printf("line %u: invalid field\n", lineno);
+			return false;
+		}
+
+		/* A symbolic field write must name exactly one set of bits */
+		for (uint32_t i = 0; i < reg->num_fields; i++) {
+			const src_field_t *f = &src->fields[reg->first_field + i];
+
+			if (strcmp(f->name, name) == 0) {
+				printf("line %u: duplicate field %s\n", lineno, name);
+				return false;
+			}
+			if (lsb < f->lsb + f->width && f->lsb <= msb) {
+				printf("line %u: field %s overlaps %s\n", lineno, name, f->name);
+				return false;
+			}
+		}
+
+		if (!grow((void **)&src->fields, src->num_fields, sizeof(src_field_t)))
+			return false;
+		src->fields[src->num_fields].name = strdup(name);
+		src->fields[src->num_fields].lsb = lsb;
+		src->fields[src->num_fields].width = msb - lsb + 1;
+		if (src->fields[src->num_fields].name == NULL)
+			return false;
+		src->num_fields++;
+		reg->num_fields++;
+		return true;
+	}
+
+	/* strtoull, sscanf %lli saturates addresses in the upper half */
+	if (sscanf(line, "%127s%n", name, &n) != 1) {
+		printf("line %u: invalid register\n", lineno);
+		return false;
+	}
+	p = line + n;
+	if (!parse_number(&p, &address) ||
+	    (strspn(p, " \t\r\n") != strlen(p) && !parse_number(&p, &size)) ||
+	    (size != 8 && size != 16 && size != 32 && size != 64)) {
+		printf("line %u: invalid register\n", lineno);
+		return false;
+	}
+
+	if (!grow((void **)&src->regs, src->num_regs, sizeof(src_reg_t)))
+		return false;
+	src->regs[src->num_regs].name = strdup(name);
+	src->regs[src->num_regs].address = address;
+	src->regs[src->num_regs].size = size;
+	src->regs[src->num_regs].first_field = src->num_fields;
+	src->regs[src->num_regs].num_fields = 0;
+	if (src->regs[src->num_regs].name == NULL)
+		return false;
+	src->num_regs++;
+	return true;
+}
+
+/**
+ * parse_file - read a text register map
+ */
+static bool parse_file(src_map_t *src, const char *path)
+{
+	char line[512];
+	unsigned int lineno = 0;
+	FILE *fp;
+	bool ok = true;
+
+	fp = fopen(path, "r");
+	if (fp == NULL) {
+		printf("Unable to open file %s\n", path);
+		return false;
+	}
+
+	while (ok && fgets(line, sizeof(line), fp) != NULL) {
+		char *p = line;
+
+		lineno++;
+		while (isspace((unsigned char)*p))
+			p++;
+		if (*p == '\0' || *p == '#')
+			continue;
+		ok = parse_line(src, line, lineno);
+	}
+
+	fclose(fp);
+	return ok;
+}
+
+/**
+ * build_hash - place every register in a perfect hash slot (hash and displace)
+ *
+ * Registers are grouped into buckets by their unseeded hash. Buckets are
+ * counting sorted by size and placed largest first, each searching for a
+ * seed that sends all of its registers to free slots.
+ */
+static bool build_hash(src_map_t *src, uint32_t num_buckets, uint32_t *disp)
+{
+	uint32_t n = src->num_regs;
+	uint32_t *order = NULL, *count = NULL, *start = NULL, *slots = NULL;
+	uint32_t *buckets = NULL, *sizes = NULL;
+	uint32_t max_size = 0;
+	bool *taken = NULL;
+	bool ok = false;
+
+	order = malloc(n * sizeof(uint32_t));
+	count = calloc(num_buckets, sizeof(uint32_t));
+	start = calloc(num_buckets + 1, sizeof(uint32_t));
+	slots = malloc(n * sizeof(uint32_t));
+	taken = calloc(n, sizeof(bool));
+	buckets = malloc(num_buckets * sizeof(uint32_t));
+	if (order == NULL || count == NULL || start == NULL || slots == NULL || taken == NULL || buckets == NULL)
+		goto end;
+
+	/* Group register indices by bucket */
+	for (uint32_t i = 0; i < n; i++) {
+		src->regs[i].bucket = regmap_hash(src->regs[i].name, strlen(src->regs[i].name), 0) % num_buckets;
+		count[src->regs[i].bucket]++;
+	}
+	for (uint32_t b = 0; b < num_buckets; b++)
+		start[b + 1] = start[b] + count[b];
+	memset(count, 0, num_buckets * sizeof(uint32_t));
+	for (uint32_t i = 0; i < n; i++) {
+		uint32_t b = src->regs[i].bucket;
+
+		order[start[b] + count[b]++] = i;
+	}
+
+	/* Identical names always share a bucket */
+	for (uint32_t b = 0; b < num_buckets; b++) {
+		for (uint32_t i = start[b]; i < start[b + 1]; i++) {
+			for (uint32_t j = i + 1; j < start[b + 1]; j++) {
+				if (strcmp(src->regs[order[i]].name, src->regs[order[j]].name) == 0) {
+					printf("Duplicate register %s\n", src->regs[order[i]].name);
+					goto end;
+				}
+			}
+		}
+	}
+
+	/* Sort buckets by size, largest first, in bucket order within a size */
+	for (uint32_t b = 0; b < num_buckets; b++)
+		if (count[b] > max_size)
+			max_size = count[b];
+	sizes = calloc(max_size + 2, sizeof(uint32_t));
+	if (sizes == NULL)
+		goto end;
+	for (uint32_t b = 0; b < num_buckets; b++)
+		sizes[max_size - count[b] + 1]++;
+	for (uint32_t i = 1; i <= max_size + 1; i++)
+		sizes[i] += sizes[i - 1];
+	for (uint32_t b = 0; b < num_buckets; b++)
+		buckets[sizes[max_size - count[b]]++] = b;
+
+	/* Place buckets from the largest down */
+	for (uint32_t i = 0; i < num_buckets && count[buckets[i]] > 0; i++) {
+		uint32_t b = buckets[i];
+		uint32_t size = count[b];
+		uint32_t d;
+
+		for (d = 1; d < REGMAP_MAX_DISP; d++) {
+			uint32_t k;
+
+			for (k = 0; k < size; k++) {
+				src_reg_t *reg = &src->regs[order[start[b] + k]];
+				uint32_t slot = regmap_hash(reg->name, strlen(reg->name), d) % n;
+				uint32_t j;
+
+				if (taken[slot])
+					break;
+				for (j = 0; j < k; j++)
+					if (slots[j] == slot)
+						break;
+				if (j != k)
+					break;
+				slots[k] = slot;
+			}
+			if (k == size)
+				break;
+		}
+		if (d == REGMAP_MAX_DISP) {
+			printf("Unable to build perfect hash\n");
+			goto end;
+		}
+
+		disp[b] = d;
+		for (uint32_t k = 0; k < size; k++) {
+			taken[slots[k]] = true;
+			src->regs[order[start[b] + k]].slot = slots[k];
+		}
+	}
+	ok = true;
+
+end:
+	free(order);
+	free(count);
+	free(start);
+	free(slots);
+	free(taken);
+	free(buckets);
+	free(sizes);
+	return ok;
+}
+
+/**
+ * add_string - append a NUL terminated name to the string table
+ */
+static bool add_string(char **table, size_t *size, const char *name, uint32_t *offset)
+{
+	size_t len = strlen(name) + 1;
+	char *p;
+
+	p = realloc(*table, *size + len);
+	if (p == NULL)
+		return false;
+	memcpy(p + *size, name, len);
+	*table = p;
+	*offset = *size;
+	*size += len;
+	return true;
+}
+
+/**
+ * write_map - serialise the hashed map in the compiled layout
+ */
+static bool write_map(src_map_t *src, uint32_t num_buckets, const uint32_t *disp, const char *path)
+{
+	regmap_header_t hdr;
+	regmap_reg_t *regs = NULL;
+	regmap_field_t *fields = NULL;
+	char *strings = NULL;
+	size_t string_size = 0;
+	uint32_t next_field = 0;
+	uint32_t empty;
+	uint8_t pad[8] = { 0 };
+	FILE *fp = NULL;
+	bool ok = false;
+
+	regs = calloc(src->num_regs ? src->num_regs : 1, sizeof(regmap_reg_t));
+	fields = calloc(src->num_fields ? src->num_fields : 1, sizeof(regmap_field_t));
+	if (regs == NULL || fields == NULL)
+		goto end;
+
+	/* Offset 0 is the empty name, so the table is never empty */
+	if (!add_string(&strings, &string_size, "", &empty))
+		goto end;
+
+	/* Registers in slot order, fields grouped after their register */
+	for (size_t i = 0; i < src->num_regs; i++) {
+		src_reg_t *s = &src->regs[i];
+		regmap_reg_t *r = &regs[s->slot];
+
+		r->address = s->address;
+		r->size = s->size;
+		r->first_field = next_field;
+		r->num_fields = s->num_fields;
+		if (!add_string(&strings, &string_size, s->name, &r->name))
+			goto end;
+
+		for (uint32_t f = 0; f < s->num_fields; f++) {
+			src_field_t *sf = &src->fields[s->first_field + f];
+
+			fields[next_field].lsb = sf->lsb;
+			fields[next_field].width = sf->width;
+			if (!add_string(&strings, &string_size, sf->name, &fields[next_field].name))
+				goto end;
+			next_field++;
+		}
+	}
+
+	memset(&hdr, 0, sizeof(hdr));
+	hdr.magic = REGMAP_MAGIC;
+	hdr.version = REGMAP_VERSION;
+	hdr.num_buckets = num_buckets;
+	hdr.num_regs = src->num_regs;
+	hdr.num_fields = src->num_fields;
+	hdr.disp_offset = sizeof(hdr);
+	/* Keep the 64-bit register addresses naturally aligned */
+	hdr.reg_offset = (hdr.disp_offset + num_buckets * sizeof(uint32_t) + 7) & ~7U;
+	hdr.field_offset = hdr.reg_offset + src->num_regs * sizeof(regmap_reg_t);
+	hdr.string_offset = hdr.field_offset + src->num_fields * sizeof(regmap_field_t);
+	hdr.string_size = string_size;
+
+	fp = fopen(path, "wb");
+	if (fp == NULL) {
+		printf("Unable to open file %s\n", path);
+		goto end;
+	}
+
+	if (fwrite(&hdr, sizeof(hdr), 1, fp) != 1 ||
+	    fwrite(disp, sizeof(uint32_t), num_buckets, fp) != num_buckets ||
+	    fwrite(pad, 1, hdr.reg_offset - hdr.disp_offset - num_buckets * sizeof(uint32_t), fp) !=
+	    hdr.reg_offset - hdr.disp_offset - num_buckets * sizeof(uint32_t) ||
+	    fwrite(regs, sizeof(regmap_reg_t), src->num_regs, fp) != src->num_regs ||
+	    fwrite(fields, sizeof(regmap_field_t), src->num_fields, fp) != src->num_fields ||
+	    fwrite(strings, 1, string_size, fp) != string_size) {
+		printf("Unable to write to file %s\n", path);
+		goto end;
+	}
+	ok = true;
+
+end:
+	if (fp != NULL && fclose(fp) != 0) {
+		printf("Unable to close file %s\n", path);
+		ok = false;
+	}
+	free(regs);
+	free(fields);
+	free(strings);
+	return ok;
+}
+
+/**
+ * regmap_compile - compile a text register map into the mmap-able format
+ */
+bool regmap_compile(const char *input, const char *output)
+{
+	src_map_t src;
+	uint32_t num_buckets;
+	uint32_t *disp = NULL;
+	bool ok = false;
+
+	memset(&src, 0, sizeof(src));
+
+	if (!parse_file(&src, input))
+		goto end;
+
+	/* Two registers per bucket on average keeps the seed search short */
+	num_buckets = (src.num_regs + 1) / 2;
+	if (num_buckets == 0)
+		num_buckets = 1;
+
+	disp = calloc(num_buckets, sizeof(uint32_t));
+	if (disp == NULL)
+		goto end;
+
+	if (!build_hash(&src, num_buckets, disp))
+		goto end;
+
+	ok = write_map(&src, num_buckets, disp, output);
+
+end:
+	for (size_t i = 0; i < src.num_regs; i++)
+		free(src.regs[i].name);
+	for (size_t i = 0; i < src.num_fields; i++)
+		free(src.fields[i].name);
+	free(src.regs);
+	free(src.fields);
+	free(disp);
+	return ok;
+}
@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2026, Analog Devices Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+
+#include "regmap.h"
+
+/* Command line arguments */
+#define ARG_INPUT 1
+#define ARG_OUTPUT 2
+
+/* Command help */
+#define HELP "\n\
+Compile a text register map for optee_app_adimem \n\
+\n\
+Usage: %s input output \n\
+  - input:  text register map, one register per line followed by its \n\
+            indented fields: \n\
+              BLOCK.REG  address  [size] \n\
+                  FIELD  msb[:lsb] \n\
+  - output: compiled map, e.g. " REGMAP_DEFAULT_PATH " \n\
+\n"
+
+/* MAIN */
+int main(int argc, char *argv[])
+{
+	if (argc != 3) {
+		printf(HELP, argv[0]);
+		return 1;
+	}
+
+	return regmap_compile(argv[ARG_INPUT], argv[ARG_OUTPUT]) ? 0 : 1;
+}
@@ -0,0 +1,231 @@
+/*
+ * Copyright (c) 2026, Analog Devices Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "snapshot.h"
+
+/* Equal blocks are skipped with memcmp at these granularities */
+#define DIFF_PAGE 4096
+#define DIFF_LINE 64
+
+/**
+ * snapshot_capture - read a region with bulk reads and save it as a snapshot
+ */
+bool snapshot_capture(adimem_session_t *session, uint64_t address, uint64_t length, size_t size,
+		      const char *path)
+{
+	snapshot_header_t hdr;
+	uint8_t *data;
+	FILE *fp;
+	bool ok = false;
+
+	if (length > SIZE_MAX)
+		return false;
+
+	data = malloc(length);
+	if (data == NULL) {
+		printf("Unable to allocate %llu bytes\n", (unsigned long long)length);
+		return false;
+	}
+
+	if (adi_read_memory_bulk(session, address, length, size, data) != TEEC_SUCCESS) {
+		free(data);
+		return false;
+	}
+
+	memset(&hdr, 0, sizeof(hdr));
+	hdr.magic = SNAPSHOT_MAGIC;
+	hdr.version = SNAPSHOT_VERSION;
+	hdr.address = address;
+	hdr.length = length;
+	hdr.size = size;
+	hdr.timestamp = time(NULL);
+
+	fp = fopen(path, "wb");
+	if (fp == NULL) {
+		printf("Unable to open file %s\n", path);
+		free(data);
+		return false;
+	}
+
+	if (fwrite(&hdr, sizeof(hdr), 1, fp) != 1 || fwrite(data, 1, length, fp) != length)
+		printf("Unable to write to file %s\n", path);
+	else
+		ok = true;
+
+	if (fclose(fp) != 0) {
+		printf("Unable to close file %s\n", path);
+		ok = false;
+	}
+	free(data);
+
+	return ok;
+}
+
+/**
+ * snapshot_open - map a snapshot file
+ */
+bool snapshot_open(snapshot_t *snap, const char *path)
+{
+	struct stat st;
+	int fd;
+
+	memset(snap, 0, sizeof(*snap));
+
+	fd = open(path, O_RDONLY);
+	if (fd < 0) {
+		printf("Unable to open file %s\n", path);
+		return false;
+	}
+
+	if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(snapshot_header_t)) {
+		printf("Invalid snapshot %s\n", path);
+		close(fd);
+		return false;
+	}
+
+	snap->base = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (snap->base == MAP_FAILED) {
+		printf("Unable to map file %s\n", path);
+		snap->base = NULL;
+		return false;
+	}
+	snap->len = st.st_size;
+	snap->hdr = snap->base;
+	snap->data = (const uint8_t *)snap->base + sizeof(snapshot_header_t);
+
+	if (snap->hdr->magic != SNAPSHOT_MAGIC || snap->hdr->version != SNAPSHOT_VERSION ||
+	    snap->hdr->length != snap->len - sizeof(snapshot_header_t) ||
+	    (snap->hdr->size != 8 && snap->hdr->size != 16 && snap->hdr->size != 32 && snap->hdr->size != 64)) {
+		printf("Invalid snapshot %s\n", path);
+		snapshot_close(snap);
+		return false;
+	}
+
+	/* The data is only read front to back */
+	madvise(snap->base, snap->len, MADV_SEQUENTIAL);
+
+	return true;
+}
+
+/**
+ * snapshot_close - unmap a snapshot
+ */
+void snapshot_close(snapshot_t *snap)
+{
+	if (snap->base != NULL)
+		munmap(snap->base, snap->len);
+	memset(snap, 0, sizeof(*snap));
+}
+
+/**
+ * diff_words - print the size bit words that differ in [off, off + len)
+ *
+ * A trailing partial word is compared on its own.
+ */
+static uint64_t diff_words(uint64_t address, const uint8_t *old, const uint8_t *new, uint64_t off,
+			   uint64_t len, size_t size)
+{
+	uint64_t changed = 0;
+	uint64_t width;
+	uint64_t a, b;
+
+	for (uint64_t end = off + len; off < end; off += width) {
+		width = (end - off < size / 8) ? end - off : size / 8;
+		a = 0;
+		b = 0;
+		memcpy(&a, old + off, width);
+		memcpy(&b, new + off, width);
+		if (a == b)
+			continue;
+		printf("0x%llx: 0x%0*llx -> 0x%0*llx\n", (unsigned long long)(address + off),
+		       (int)(2 * width), (unsigned long long)a, (int)(2 * width), (unsigned long long)b);
+		changed++;
+	}
+
+	return changed;
+}
+
+/**
+ * snapshot_diff - print every size bit word that differs between two copies of a region
+ *
+ * Equal pages and cache lines are skipped with memcmp, which libc vectorises;
+ * differing lines are scanned 64 bits at a time and only changed words are
+ * decoded and printed. Returns the number of changed words.
+ */
+uint64_t snapshot_diff(uint64_t address, const uint8_t *old, const uint8_t *new, uint64_t length,
+		       size_t size)
+{
+	uint64_t changed = 0;
+	uint64_t off = 0;
+	uint64_t a, b;
+
+	/* Pages, lines and 64-bit chunks hold whole words of any access width */
+	while (off < length) {
+		uint64_t page = (length - off < DIFF_PAGE) ? length - off : DIFF_PAGE;
+
+		if (memcmp(old + off, new + off, page) == 0) {
+			off += page;
+			continue;
+		}
+
+		for (uint64_t end = off + page; off < end; ) {
+			uint64_t line = (end - off < DIFF_LINE) ? end - off : DIFF_LINE;
+
+			if (memcmp(old + off, new + off, line) == 0) {
+				off += line;
+				continue;
+			}
+
+			for (uint64_t line_end = off + line; off < line_end; ) {
+				uint64_t chunk = (line_end - off < 8) ? line_end - off : 8;
+
+				if (chunk == 8) {
+					memcpy(&a, old + off, 8);
+					memcpy(&b, new + off, 8);
+					if (a == b) {
+						off += 8;
+						continue;
+					}
+				}
+				changed += diff_words(address, old, new, off, chunk, size);
+				off += chunk;
+			}
+		}
+	}
+
+	return changed;
+}
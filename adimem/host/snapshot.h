@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2026, Analog Devices Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "adimem.h"
+
+/*
+ * Snapshot file: a header followed by the raw bytes of the region. The
+ * header is padded to 64 bytes so the data stays aligned when mapped.
+ */
+#define SNAPSHOT_MAGIC 0x4e534441       /* "ADSN" */
+#define SNAPSHOT_VERSION 1
+
+typedef struct snapshot_header {
+	uint32_t magic;
+	uint32_t version;
+	uint64_t address;       /* Address of the first byte */
+	uint64_t length;        /* Number of bytes */
+	uint64_t size;          /* Widest access width used to capture, in bits */
+	uint64_t timestamp;     /* CLOCK_REALTIME of the capture, in s */
+	uint8_t reserved[24];
+} snapshot_header_t;
+
+/* A snapshot mapped into memory */
+typedef struct snapshot {
+	void *base;
+	size_t len;
+	const snapshot_header_t *hdr;
+	const uint8_t *data;
+} snapshot_t;
+
+bool snapshot_capture(adimem_session_t *session, uint64_t address, uint64_t length, size_t size,
+		      const char *path);
+bool snapshot_open(snapshot_t *snap, const char *path);
+void snapshot_close(snapshot_t *snap);
+uint64_t snapshot_diff(uint64_t address, const uint8_t *old, const uint8_t *new, uint64_t length,
+		       size_t size);
+
+#endif /* SNAPSHOT_H */
@@ -0,0 +1,249 @@
+/*
+ * Copyright (c) 2026, Analog Devices Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "hexdump.h"
+
+/* Longest line: 16 digit address, ": ", 3 chars per byte, "  |", text, "|\n" */
+#define HEXDUMP_LINE_MAX (16 + 2 + 3 * HEXDUMP_LINE_BYTES_MAX + 3 + HEXDUMP_LINE_BYTES_MAX + 2)
+
+/* Two hex digits of every byte value, indexed by 2 * byte */
+#define HEX_ROW(hi) \
+	hi "0" hi "1" hi "2" hi "3" hi "4" hi "5" hi "6" hi "7" \
+	hi "8" hi "9" hi "a" hi "b" hi "c" hi "d" hi "e" hi "f"
+static const char hex_pairs[] =
+	HEX_ROW("0") HEX_ROW("1") HEX_ROW("2") HEX_ROW("3")
+	HEX_ROW("4") HEX_ROW("5") HEX_ROW("6") HEX_ROW("7")
+	HEX_ROW("8") HEX_ROW("9") HEX_ROW("a") HEX_ROW("b")
+	HEX_ROW("c") HEX_ROW("d") HEX_ROW("e") HEX_ROW("f");
+
+/**
+ * put_byte - write the two hex digits of a byte
+ */
+static inline char *put_byte(char *out, uint8_t b)
+{
+	memcpy(out, &hex_pairs[2 * b], 2);
+	return out + 2;
+}
+
+/**
+ * hexdump_format_init - default format, 4 byte words in host order with text
+ */
+void hexdump_format_init(hexdump_format_t *fmt)
+{
+	memset(fmt, 0, sizeof(*fmt));
+	fmt->width = 4;
+	fmt->order = HEXDUMP_ORDER_DEFAULT;
+	fmt->line_bytes = HEXDUMP_LINE_BYTES;
+	fmt->ascii = true;
+}
+
+/**
+ * hexdump_parse_format - set width and order from "width[:little|big]"
+ *
+ * width is the word size in bytes, 1, 2, 4 or 8.
+ */
+bool hexdump_parse_format(const char *spec, hexdump_format_t *fmt)
+{
+	char *end;
+	unsigned long width;
+
+	width = strtoul(spec, &end, 0);
+	if (end == spec || (width != 1 && width != 2 && width != 4 && width != 8))
+		return false;
+
+	if (*end == '\0')
+		fmt->order = HEXDUMP_ORDER_DEFAULT;
+	else if (strcmp(end, ":little") == 0)
+		fmt->order = HEXDUMP_ORDER_LITTLE;
+	else if (strcmp(end, ":big") == 0)
+		fmt->order = HEXDUMP_ORDER_BIG;
+	else
+		return false;
+	fmt->width = width;
+
+	return true;
+}
+
+/**
+ * hexdump_init - start formatting to fd
+ */
+bool hexdump_init(hexdump_t *hd, const hexdump_format_t *fmt, int fd)
+{
+	memset(hd, 0, sizeof(*hd));
+	hd->fmt = *fmt;
+	hd->fd = fd;
+
+	if (fmt->width == 0 || fmt->line_bytes == 0 || fmt->line_bytes > HEXDUMP_LINE_BYTES_MAX ||
+	    fmt->line_bytes % fmt->width != 0)
+		return false;
+
+	hd->buf = malloc(HEXDUMP_BUF_SIZE);
+
+	return hd->buf != NULL;
+}
+
+/**
+ * flush - write out the collected text
+ */
+static bool flush(hexdump_t *hd)
+{
+	char *p = hd->buf;
+	ssize_t n;
+
+	while (hd->len > 0 && !hd->failed) {
+		n = write(hd->fd, p, hd->len);
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n <= 0) {
+			hd->failed = true;
+			break;
+		}
+		p += n;
+		hd->len -= n;
+	}
+	hd->len = 0;
+
+	return !hd->failed;
+}
+
+/**
+ * format_line - append one line of up to fmt.line_bytes bytes to the buffer
+ *
+ * Every digit comes from hex_pairs; a short last word is shown byte by byte.
+ */
+static void format_line(hexdump_t *hd, const uint8_t *data, size_t n)
+{
+	const hexdump_format_t *fmt = &hd->fmt;
+	uint64_t addr = fmt->base + hd->pos;
+	unsigned int w = fmt->width;
+	bool big = (fmt->order == HEXDUMP_ORDER_BIG);
+	char *out = hd->buf + hd->len;
+	char *start = out;
+	size_t i, k;
+	int s;
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+	if (fmt->order == HEXDUMP_ORDER_DEFAULT)
+		big = true;
+#endif
+
+	for (s = (addr >> 32) ? 56 : 24; s >= 0; s -= 8)
+		out = put_byte(out, addr >> s);
+	*out++ = ':';
+
+	for (i = 0; i + w <= n; i += w) {
+		*out++ = ' ';
+		for (k = 0; k < w; k++)
+			out = put_byte(out, data[i + (big ? k : w - 1 - k)]);
+	}
+	for (; i < n; i++) {
+		*out++ = ' ';
+		out = put_byte(out, data[i]);
+	}
+
+	if (fmt->ascii) {
+		/* Keep the text column aligned on a short last line */
+		k = fmt->line_bytes / w * (2 * w + 1) - (n / w * (2 * w + 1) + n % w * 3);
+		memset(out, ' ', k + 2);
+		out += k + 2;
+		*out++ = '|';
+		for (i = 0; i < n; i++)
+			*out++ = (data[i] >= 0x20 && data[i] < 0x7f) ? data[i] : '.';
+		*out++ = '|';
+	}
+	*out++ = '\n';
+
+	hd->len += out - start;
+	hd->pos += n;
+}
+
+/**
+ * hexdump_write - format the next len bytes
+ *
+ * Whole lines are formatted straight from data; bytes of an unfinished line
+ * are kept until the rest arrives or hexdump_finish().
+ */
+bool hexdump_write(hexdump_t *hd, const uint8_t *data, size_t len)
+{
+	size_t line_bytes = hd->fmt.line_bytes;
+	size_t n;
+
+	if (hd->line_len > 0) {
+		n = line_bytes - hd->line_len;
+		if (n > len)
+			n = len;
+		memcpy(hd->line + hd->line_len, data, n);
+		hd->line_len += n;
+		data += n;
+		len -= n;
+		if (hd->line_len < line_bytes)
+			return !hd->failed;
+		if (HEXDUMP_BUF_SIZE - hd->len < HEXDUMP_LINE_MAX && !flush(hd))
+			return false;
+		format_line(hd, hd->line, line_bytes);
+		hd->line_len = 0;
+	}
+
+	while (len >= line_bytes) {
+		if (HEXDUMP_BUF_SIZE - hd->len < HEXDUMP_LINE_MAX && !flush(hd))
+			return false;
+		format_line(hd, data, line_bytes);
+		data += line_bytes;
+		len -= line_bytes;
+	}
+
+	memcpy(hd->line, data, len);
+	hd->line_len = len;
+
+	return !hd->failed;
+}
+
+/**
+ * hexdump_finish - format an unfinished last line, write everything out and free
+ */
+bool hexdump_finish(hexdump_t *hd)
+{
+	bool ok;
+
+	if (hd->buf == NULL)
+		return false;
+
+	if (hd->line_len > 0 && (HEXDUMP_BUF_SIZE - hd->len >= HEXDUMP_LINE_MAX || flush(hd)))
+		format_line(hd, hd->line, hd->line_len);
+	ok = flush(hd);
+
+	free(hd->buf);
+	hd->buf = NULL;
+
+	return ok;
+}
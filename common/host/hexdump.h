@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2026, Analog Devices Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef HEXDUMP_H
+#define HEXDUMP_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Bytes shown per line, and the most a format may ask for */
+#define HEXDUMP_LINE_BYTES 16
+#define HEXDUMP_LINE_BYTES_MAX 64
+
+/* Output is collected and written in blocks of this size */
+#define HEXDUMP_BUF_SIZE (1024 * 1024)
+
+/* Byte order words are read in */
+enum hexdump_order {
+	HEXDUMP_ORDER_DEFAULT,  /* Left to the caller, host order if not resolved */
+	HEXDUMP_ORDER_LITTLE,
+	HEXDUMP_ORDER_BIG,
+};
+
+typedef struct hexdump_format {
+	unsigned int width;             /* Bytes per word: 1, 2, 4 or 8 */
+	enum hexdump_order order;
+	unsigned int line_bytes;        /* Multiple of width, up to HEXDUMP_LINE_BYTES_MAX */
+	bool ascii;                     /* Printable characters column */
+	uint64_t base;                  /* Address shown for byte 0 */
+} hexdump_format_t;
+
+/*
+ * Formatter writing to a file descriptor. fmt may be changed up to the first
+ * hexdump_write(), e.g. once the base address of a record is known.
+ */
+typedef struct hexdump {
+	hexdump_format_t fmt;
+	int fd;
+	char *buf;
+	size_t len;
+	uint64_t pos;                   /* Bytes formatted so far */
+	uint8_t line[HEXDUMP_LINE_BYTES_MAX];
+	size_t line_len;                /* Bytes of an unfinished line */
+	bool failed;
+} hexdump_t;
+
+void hexdump_format_init(hexdump_format_t *fmt);
+bool hexdump_parse_format(const char *spec, hexdump_format_t *fmt);
+bool hexdump_init(hexdump_t *hd, const hexdump_format_t *fmt, int fd);
+bool hexdump_write(hexdump_t *hd, const uint8_t *data, size_t len);
+bool hexdump_finish(hexdump_t *hd);
+
+#endif /* HEXDUMP_H */